@@ -0,0 +1,23 @@
+#!/bin/bash
+
+# NOTE:
+# Starts a HAM-Offload application built against the shared memory backend (HAM_COMM_SHM)
+# as <process_count> processes on the local machine, address 0 is the host process.
+# Usage: ./run_shm.sh <process_count> <executable> [<args>...]
+# Returns the exit code of the host process.
+
+PROCESS_COUNT=${1}
+shift
+
+# unique segment names for concurrently running jobs
+SHM_NAME="ham_ci_$$"
+
+for ((ADDRESS = 1; ADDRESS < PROCESS_COUNT; ADDRESS++)); do
+	"$@" --ham-process-count ${PROCESS_COUNT} --ham-address ${ADDRESS} --ham-shm-name ${SHM_NAME} &
+done
+
+"$@" --ham-process-count ${PROCESS_COUNT} --ham-address 0 --ham-shm-name ${SHM_NAME}
+HOST_RESULT=$?
+
+wait
+exit ${HOST_RESULT}
@@ -6,8 +6,11 @@
 #ifndef ham_functor_buffer_hpp
 #define ham_functor_buffer_hpp
 
+#include "ham/misc/traits.hpp"
 #include "ham/net/communicator.hpp"
 
+#include <cstring> // memcpy
+
 namespace ham {
 
 template<class T>
@@ -41,6 +44,62 @@ private:
 	net::buffer_ptr<T> ptr;
 };
 
+// executed on the node of dest, reads n elements from source, which may be on another node
+// NOTE: for two-sided communicators, only if source is on the same node, since there is no matching send operation
+template<class T>
+class copy_buffer {
+public:
+	using result_type = void;
+	copy_buffer(const net::buffer_ptr<T>& source, const net::buffer_ptr<T>& dest, size_t n) : source(source), dest(dest), n(n) { }
+
+	result_type operator()()
+	{
+		if (source.node() == dest.node())
+			memcpy(static_cast<void*>(dest.get()), static_cast<const void*>(source.get()), n * sizeof(T));
+		else
+			net::communicator::instance().recv_data(source, dest.get(), n);
+	}
+private:
+	net::buffer_ptr<T> source;
+	net::buffer_ptr<T> dest;
+	size_t n;
+};
+
+// executed on the node of buffer, after count elements at offset arrived, see offload::put_chunked()
+template<class T, class Callback>
+class chunk_callback {
+public:
+	using result_type = void;
+	chunk_callback(const Callback& callback, const net::buffer_ptr<T>& buffer, size_t offset, size_t count) : callback(callback), buffer(buffer), offset(offset), count(count) { }
+
+	result_type operator()()
+	{
+		callback(buffer, offset, count);
+	}
+private:
+	Callback callback;
+	net::buffer_ptr<T> buffer;
+	size_t offset;
+	size_t count;
+};
+
+// NOTE: allocating and freeing do not wait for anything, so they are executed by the receiving thread of the target
+template<class T>
+struct is_blocking<new_buffer<T>> {
+	static constexpr bool value = false;
+};
+
+template<class T>
+struct is_blocking<delete_buffer<T>> {
+	static constexpr bool value = false;
+};
+
+// a chunk callback is as blocking as the callback itself
+template<class T, class Callback>
+struct is_blocking<chunk_callback<T, Callback>> {
+	static constexpr bool value = is_blocking<Callback>::value;
+};
+
 } // namespace ham
 
 #endif // ham_functor_buffer_hpp
@@ -11,12 +11,36 @@
 #define HAM_MESSAGE_SIZE 4096
 #endif
 
+// number of pre-posted message receives on MPI offload targets
+#ifndef HAM_MPI_RECV_RING_SIZE
+#define HAM_MPI_RECV_RING_SIZE 16
+#endif
+
+// number of result sends that may be in flight on MPI offload targets
+#ifndef HAM_MPI_RESULT_SENDS
+#define HAM_MPI_RESULT_SENDS 16
+#endif
+
+// put() and get() of up to this many bytes carry their data inside the messages on two-sided communicators
+#ifndef HAM_INLINE_TRANSFER_SIZE
+#define HAM_INLINE_TRANSFER_SIZE 1024
+#endif
+
 namespace ham {
 namespace constants {
 
+// NOTE: defaults of --ham-msg-size and --ham-msg-buffers, fixed values for backends without runtime sizing (SCIF, VEO, VEDMA)
 enum net {
 	MSG_SIZE = HAM_MESSAGE_SIZE,
 	MSG_BUFFERS = 256,
+	MIN_MSG_SIZE = 0x200, // 512 B, lower bound of --ham-msg-size, functors that fit are always sent eagerly
+};
+
+// NOTE: defaults of the data transfers, see offload::put(), offload::put_chunked()
+enum transfer {
+	CHUNK_WINDOW = 4, // chunks in flight
+	INLINE_TRANSFER_SIZE = HAM_INLINE_TRANSFER_SIZE, // B
+	ARENA_MIN_BLOCK = 0x40, // 64 B (a cache line), smallest size class of offload::arena
 };
 
 enum arch {
@@ -31,6 +55,10 @@ enum mpi {
 	RESULT_TAG = 1,
 	DATA_TAG = 2,
 	SYNC_TAG = 3,
+	// per-request tags, so that concurrent requests from multiple host threads cannot match each other's results and data
+	RESULT_TAG_BASE = 0x100, // + source_buffer_index of the request, the data tags of each initiating node follow behind the result tags of all message buffers
+	RECV_RING_SIZE = HAM_MPI_RECV_RING_SIZE,
+	RESULT_SENDS = HAM_MPI_RESULT_SENDS,
 };
 
 
@@ -36,6 +36,12 @@ public:
 //		std::cout << "migratable-conversion: " << value << std::endl;
 		return value;
 	}
+
+	// non-const access, e.g. to move the value out, see result_container::get()
+	T& get()
+	{
+		return value;
+	}
 private:
 	T value;
 };
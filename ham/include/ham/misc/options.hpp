@@ -15,6 +15,7 @@
 #endif
 #include <cstdlib>
 
+#include "ham/misc/constants.hpp"
 #include "ham/util/log.hpp"
 
 namespace ham {
@@ -44,6 +45,10 @@ public:
 		app_.allow_extras(); // ignore other options
 		app_.set_help_flag("--ham-help", "Print list of HAM-Offload command line options.");
 		app_.add_option("--ham-cpu-affinity", cpu_affinity_, "Per process value for the CPU affinity.");
+		app_.add_option("--ham-msg-size", msg_size_, "Size of a message buffer in bytes, limits the size of offloaded functors (default: " + std::to_string(constants::MSG_SIZE) + ").");
+		app_.add_option("--ham-msg-buffers", msg_buffers_, "Number of message buffers per peer, limits the number of outstanding requests (default: " + std::to_string(constants::MSG_BUFFERS) + ").");
+		app_.add_flag("--ham-print-footprint", print_footprint_, "Print the memory footprint of the message buffers per peer.");
+		app_.add_option("--ham-target-threads", target_threads_, "Number of worker threads per offload target, that execute offloaded functions, while the target continues to receive messages (default: 0, i.e. executed by the receiving thread).");
 #endif
 	}
 
@@ -88,6 +93,20 @@ public:
 
 	// command line argument getters
 	const int& cpu_affinity() const { return cpu_affinity_; }
+	// NOTE: rounded up to whole cache lines, so that consecutive buffers stay aligned,
+	//       at least constants::MIN_MSG_SIZE plus a cache line for the message header of some communicators (e.g. SHM)
+	size_t msg_size() const
+	{
+		const size_t min_size = constants::MIN_MSG_SIZE + constants::CACHE_LINE_SIZE;
+		const size_t size = msg_size_ < min_size ? min_size : msg_size_;
+		return (size + constants::CACHE_LINE_SIZE - 1) / constants::CACHE_LINE_SIZE * constants::CACHE_LINE_SIZE;
+	}
+	// NOTE: at least two, one buffer per peer is always pre-allocated by the one-sided backends
+	size_t msg_buffers() const { return msg_buffers_ < 2 ? 2 : msg_buffers_; }
+	bool print_footprint() const { return print_footprint_; }
+	size_t target_threads() const { return target_threads_; }
+	// for backends with fixed message buffers
+	bool default_msg_config() const { return msg_size_ == constants::MSG_SIZE && msg_buffers_ == constants::MSG_BUFFERS; }
 
 protected:
 // NOTE: no command line handling on the VE side
@@ -100,6 +119,10 @@ private:
 	char*** argv_ptr_;
 
 	int cpu_affinity_;
+	size_t msg_size_ = constants::MSG_SIZE;
+	size_t msg_buffers_ = constants::MSG_BUFFERS;
+	bool print_footprint_ = false;
+	size_t target_threads_ = 0;
 };
 
 } // namespace ham
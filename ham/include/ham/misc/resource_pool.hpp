@@ -6,35 +6,49 @@
 #ifndef ham_misc_resource_pool_hpp
 #define ham_misc_resource_pool_hpp
 
+#include <atomic>
+#include <cstdint>
 #include <iostream>
-#include <stack>
+#include <limits>
 #include <vector>
 #include "ham/misc/constants.hpp"
 
 namespace ham {
 namespace detail {
 
+// NOTE: thread-safe and lock-free, so multiple host threads can allocate requests concurrently
+//       the values live in a fixed set of nodes, that are linked into two Treiber stacks: one of free values and one of unused nodes,
+//       allocate() moves a node from the value stack to the node stack, free() the other way round
+//       each stack head is a 64 bit word of a 32 bit node index and a 32 bit tag, that is incremented on every change to avoid ABA
+//       add() grows the node set and must not run concurrently with any other operation, i.e. the pool is filled before it is shared
+//       values are re-used in LIFO order, i.e. the last freed value is allocated next, which keeps the associated buffers cache-warm
 template<typename T>
 class resource_pool
 {
 public:
     using value_type = T;
     using size_type = int;
-    using container_type = std::vector<value_type>;
 
 	//resource_pool(size_t count) //: values(count)
     resource_pool() = default; //: values(count)
 
+	// NOTE: moving is not thread-safe, it is only intended for setting up pools
 	resource_pool(const resource_pool&) = delete;
 	resource_pool(resource_pool&& other)
+	 : nodes(std::move(other.nodes)), value_head(other.value_head.load(std::memory_order_relaxed)), node_head(other.node_head.load(std::memory_order_relaxed))
 	{
-		free_stack = std::move(other.free_stack);
+		other.value_head.store(EMPTY_HEAD, std::memory_order_relaxed);
+		other.node_head.store(EMPTY_HEAD, std::memory_order_relaxed);
 	}
 
 	resource_pool& operator=(const resource_pool&) = delete;
 	resource_pool& operator=(resource_pool&& other)
 	{
-		free_stack = std::move(other.free_stack);
+		nodes = std::move(other.nodes);
+		value_head.store(other.value_head.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		node_head.store(other.node_head.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		other.value_head.store(EMPTY_HEAD, std::memory_order_relaxed);
+		other.node_head.store(EMPTY_HEAD, std::memory_order_relaxed);
 		return *this;
 	}
 
@@ -43,16 +57,18 @@ public:
 	//void add(value_type&& v)
 	void add(value_type v)
 	{
-		free_stack.push(v);
+		// NOTE: not thread-safe, see above
+		nodes.emplace_back(v);
+		push(value_head, static_cast<index_type>(nodes.size() - 1));
 		//std::cout << "resource_pool::add(), added value: " << v << std::endl;
 	}
 
 	value_type allocate()
 	{
-		// test if stack is non-empty
-		if (!free_stack.empty()) {
-			value_type result = free_stack.top();
-			free_stack.pop();
+		const index_type i = pop(value_head);
+		if (i != NO_NODE) {
+			value_type result = nodes[i].value;
+			push(node_head, i); // the node can now carry a freed value
 			return result;
 		}
 		// else:
@@ -60,11 +76,28 @@ public:
 		return value_type();
 	}
 
+	// like allocate(), but returns false instead of a default object if the pool is empty
+	bool try_allocate(value_type& value)
+	{
+		const index_type i = pop(value_head);
+		if (i == NO_NODE)
+			return false;
+		value = nodes[i].value;
+		push(node_head, i);
+		return true;
+	}
+
+	bool empty() const
+	{
+		return index(value_head.load(std::memory_order_acquire)) == NO_NODE;
+	}
+
+	// NOTE: with concurrent allocations, the returned value might already be taken when the caller uses it
 	value_type next()
 	{
-		// test if stack is non-empty
-		if (!free_stack.empty()) {
-			return free_stack.top();
+		const index_type i = index(value_head.load(std::memory_order_acquire));
+		if (i != NO_NODE) {
+			return nodes[i].value;
 		} else {
 			std::cerr << "resource_pool::next(), error: ran out of resources, returning default object." << std::endl;
 			return value_type();
@@ -73,23 +106,79 @@ public:
 
 	void free(value_type& buffer)
 	{
-		// push buffer back on free-stack
-		free_stack.emplace(buffer);
+		const index_type i = pop(node_head); // there is always a node, since every freed value has been allocated before
+		if (i == NO_NODE) {
+			std::cerr << "resource_pool::free(), error: more values freed than allocated, ignoring value." << std::endl;
+			return;
+		}
+		nodes[i].value = buffer;
+		push(value_head, i);
 	}
 
 	void free(value_type&& buffer)
 	{
-		// push buffer back on free-stack
-		free_stack.emplace(std::move(buffer));
+		const index_type i = pop(node_head);
+		if (i == NO_NODE) {
+			std::cerr << "resource_pool::free(), error: more values freed than allocated, ignoring value." << std::endl;
+			return;
+		}
+		nodes[i].value = std::move(buffer);
+		push(value_head, i);
 	}
 
 private:
-	//container_type values;
-	std::stack<value_type, std::vector<value_type>> free_stack; // pointers to resources
+	using index_type = uint32_t;
+	using head_type = uint64_t; // tag << 32 | index
+
+	static constexpr index_type NO_NODE = std::numeric_limits<index_type>::max();
+	static constexpr head_type EMPTY_HEAD = NO_NODE;
+
+	struct node {
+		node(const value_type& value) : value(value), next(NO_NODE) {}
+		node(const node& other) : value(other.value), next(other.next.load(std::memory_order_relaxed)) {} // needed by std::vector, only used by add()
+
+		value_type value;
+		std::atomic<index_type> next; // NOTE: atomic, because a concurrent pop() may read it while the node is re-linked
+	};
+
+	static index_type index(head_type head) { return static_cast<index_type>(head); }
+	static head_type make_head(index_type index, head_type old_head) { return (((old_head >> 32) + 1) << 32) | index; }
+
+	void push(std::atomic<head_type>& head, index_type i)
+	{
+		head_type old_head = head.load(std::memory_order_relaxed);
+		do {
+			nodes[i].next.store(index(old_head), std::memory_order_relaxed);
+		} while (!head.compare_exchange_weak(old_head, make_head(i, old_head), std::memory_order_release, std::memory_order_relaxed));
+	}
+
+	index_type pop(std::atomic<head_type>& head)
+	{
+		head_type old_head = head.load(std::memory_order_acquire);
+		while (index(old_head) != NO_NODE) {
+			const index_type next = nodes[index(old_head)].next.load(std::memory_order_relaxed);
+			if (head.compare_exchange_weak(old_head, make_head(next, old_head), std::memory_order_acquire, std::memory_order_acquire))
+				return index(old_head);
+		}
+		return NO_NODE;
+	}
+
+	std::vector<node> nodes; // NOTE: never resized after the pool is shared, see add()
+	// NOTE: the heads are padded to separate cache lines, they are written by every allocate() and free()
+	char padding_0[constants::CACHE_LINE_SIZE];
+	std::atomic<head_type> value_head { EMPTY_HEAD }; // stack of nodes carrying a free value
+	char padding_1[constants::CACHE_LINE_SIZE - sizeof(std::atomic<head_type>)];
+	std::atomic<head_type> node_head { EMPTY_HEAD }; // stack of nodes without a value
+	char padding_2[constants::CACHE_LINE_SIZE - sizeof(std::atomic<head_type>)];
 };
 
+template<typename T>
+constexpr typename resource_pool<T>::index_type resource_pool<T>::NO_NODE;
+
+template<typename T>
+constexpr typename resource_pool<T>::head_type resource_pool<T>::EMPTY_HEAD;
+
 } // namespace detail
 } // namespace ham
 
 #endif // ham_misc_resource_pool_hpp
-
@@ -26,6 +26,16 @@ namespace ham {
 
 /**
  * Trait to flag functor types as potentially blocking (default) or non-blocking. The latter allows for optimisations, i.e. a special execution policy.
+ * offload::async(), sync() and ping() use it to select the execution policy at compile time: non-blocking functors are
+ * executed directly by the receiving thread of the target, potentially blocking ones by its workers (see --ham-target-threads).
+ * A non-blocking functor must not wait for other messages, e.g. for the same target:
+ *
+ *     namespace ham {
+ *     template<>
+ *     struct is_blocking<F2F_TEMPLATE(&my_function)> {
+ *         static constexpr bool value = false;
+ *     };
+ *     }
  */
 template<typename First, typename... Pars>
 struct is_blocking {
@@ -28,7 +28,8 @@ class result_container
 public:
 	result_container() = default;
 	result_container(T&& res) : res(res) { }
-	T get() { return T(std::move(res)); }
+	// NOTE: moves the result out of res, which allows move-only results, e.g. those of continuations (offload::when_all())
+	T get() { return T(std::move(res.get())); }
 
 private:
 	migratable<T> res;
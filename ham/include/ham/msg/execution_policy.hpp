@@ -13,8 +13,11 @@
 #ifndef ham_msg_execution_policy_hpp
 #define ham_msg_execution_policy_hpp
 
+#include <cstring> // memcpy
 #include <string>
+#include <type_traits>
 
+#include "ham/msg/worker_pool.hpp"
 #include "ham/util/debug.hpp"
 #include "ham/util/log.hpp"
 
@@ -33,6 +36,47 @@ protected:
 	}
 };
 
+/**
+ * Executes the message on a worker thread of the receiving node, see
+ * worker_pool and --ham-target-threads, so that long-running messages do
+ * not block the receipt of other messages. Without worker threads, the
+ * message is executed directly.
+ * NOTE: only for messages without data behind the message object, since the
+ *       worker executes a copy of sizeof(Derived) bytes
+ */
+template<class Derived>
+class execution_policy_pool {
+protected:
+	static void handler(void* buffer) {
+		worker_pool* pool = worker_pool::current();
+		if (pool == nullptr) {
+			HAM_DEBUG( HAM_LOG << "execution_policy_pool::handler(): no workers, executing directly" << std::endl; )
+			Derived& functor = *reinterpret_cast<Derived*>(buffer);
+			functor();
+			return;
+		}
+		HAM_DEBUG( HAM_LOG << "execution_policy_pool::handler(): passing a copy of the message to the workers" << std::endl; )
+		// NOTE: the message buffer is re-used by the next receive, the message is a sequence of bytes, and is never destructed
+		using storage_type = typename storage<Derived>::type;
+		storage_type* copy = new storage_type;
+		memcpy(static_cast<void*>(copy), buffer, sizeof(Derived));
+		pool->submit(&execute, copy);
+	}
+
+private:
+	// NOTE: Derived is incomplete when this base class is instantiated, hence the indirection
+	template<class Msg>
+	struct storage {
+		using type = typename std::aligned_storage<sizeof(Msg), alignof(Msg)>::type;
+	};
+
+	static void execute(void* copy) {
+		Derived& functor = *reinterpret_cast<Derived*>(copy);
+		functor();
+		delete static_cast<typename storage<Derived>::type*>(copy);
+	}
+};
+
 /**
  * Defines a default execution policy.
  */
@@ -16,13 +16,24 @@
 #define ham_msg_msg_handler_registry_hpp
 
 #include "ham/msg/msg_handler_registry_abi.hpp"
+#include "ham/msg/msg_handler_registry_direct.hpp"
+#include "ham/msg/msg_handler_registry_hash.hpp"
 // NOTE: include other implementations here
 
 namespace ham {
 namespace msg {
 
-// NOTE: this sets the default, maybe use defines here for simple compile time configuration
+// NOTE: this sets the default, the hash keys need host and targets built by the same compiler,
+//       which is not the case for the vector engine backends, define HAM_MSG_HANDLER_REGISTRY_ABI to select the ABI registry,
+//       or HAM_MSG_HANDLER_REGISTRY_DIRECT for identical binaries, see CMake option HAM_MSG_HANDLER_REGISTRY
+#if defined HAM_MSG_HANDLER_REGISTRY_ABI || defined HAM_COMM_VEO || defined HAM_COMM_VEDMA
 using msg_handler_registry = msg_handler_registry_abi;
+#elif defined HAM_MSG_HANDLER_REGISTRY_DIRECT
+#define HAM_MSG_HANDLER_REGISTRY_DIRECT_SELECTED // enables the startup handshake of msg_handler_registry_direct
+using msg_handler_registry = msg_handler_registry_direct;
+#else
+using msg_handler_registry = msg_handler_registry_hash;
+#endif
 
 } // namespace msg
 } // namespace ham
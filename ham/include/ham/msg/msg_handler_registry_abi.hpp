@@ -6,6 +6,7 @@
 #ifndef ham_msg_msg_handler_registry_abi_hpp
 #define ham_msg_msg_handler_registry_abi_hpp
 
+#include <cstdint>
 #include <iostream>
 #include <limits>
 #include <map>
@@ -14,6 +15,8 @@
 #include <typeinfo>
 #include <vector>
 
+#include "ham/util/hash.hpp"
+
 namespace ham {
 namespace msg {
 
@@ -39,6 +42,9 @@ namespace msg {
  * O(1). On the remote side, the index is used to get the handler from the
  * vector in O(1).
  *
+ * checksum() is a hash of all typeid names, that allows a fast check whether
+ * two binaries have the same handlers.
+ *
  * This class is a monostate (i.e. everything is static).
  */
 class msg_handler_registry_abi {
@@ -57,10 +63,13 @@ public:
 		handler_map_type& handler_map = get_handler_map();
 		handler_vector_type& handler_vector = get_handler_vector();
 		size_t index = 0;
+		uint64_t& checksum = get_checksum();
+		checksum = util::FNV1A_OFFSET_BASIS;
 		for (auto& key_value_pair : handler_map)
 		{
 			handler_vector.push_back(key_value_pair.second.first); // store the handler
 			key_value_pair.second.second(index); // this actually calls active_msg::set_handler_index()
+			checksum = util::fnv1a(key_value_pair.first.c_str(), key_value_pair.first.size() + 1, checksum); // including the terminating zero
 			++index;
 		}
 	}
@@ -77,6 +86,10 @@ public:
 		return INVALID_KEY_VALUE;
 	}
 
+	// the number of handlers, and a hash of their names, that are the same for compatible binaries
+	static size_t size() { return get_handler_vector().size(); }
+	static uint64_t checksum() { return get_checksum(); }
+
 	static void print_handler_map(std::ostream& out)
 	{
 		handler_map_type& handler_map = get_handler_map();
@@ -126,6 +139,11 @@ protected:
 		return handler_vector;
 	}
 
+	static uint64_t& get_checksum() {
+		static uint64_t checksum = 0;
+		return checksum;
+	}
+
 	static const key_type INVALID_KEY_VALUE { std::numeric_limits<key_type>::max() };
 };
 
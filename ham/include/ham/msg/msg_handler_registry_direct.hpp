@@ -0,0 +1,99 @@
+// Copyright (c) 2013-2026 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ham_msg_msg_handler_registry_direct_hpp
+#define ham_msg_msg_handler_registry_direct_hpp
+
+#include <cstdint>
+
+#include "ham/msg/msg_handler_registry_abi.hpp"
+#include "ham/util/hash.hpp"
+
+namespace ham {
+namespace msg {
+
+/**
+ * Implementation of the msg_handler_registry concept for identical binaries
+ * on host and targets, that directly uses handler addresses as keys.
+ * The key of a handler is its address relative to anchor(), so it does not
+ * depend on the load address of the binary (ASLR). Dispatching a message is
+ * a single addition and an indirect call.
+ *
+ * It starts out as msg_handler_registry_abi, i.e. with indices as keys.
+ * At startup, the runtime compares offsets_checksum(), a hash of all
+ * relative handler addresses, of the host and all targets. Only if they all
+ * match, enable_direct() is called on every node, which re-assigns all
+ * handler keys. Otherwise the registry stays in ABI mode.
+ *
+ * This class is a monostate (i.e. everything is static).
+ */
+class msg_handler_registry_direct : public msg_handler_registry_abi {
+public:
+	using key_type = msg_handler_registry_abi::key_type; // an index, or an address relative to anchor()
+	using handler_type = msg_handler_registry_abi::handler_type;
+
+	static void init()
+	{
+		msg_handler_registry_abi::init();
+
+		// NOTE: in the order of the names, like the indices
+		uint64_t& checksum = get_offsets_checksum();
+		checksum = util::FNV1A_OFFSET_BASIS;
+		for (auto& key_value_pair : get_handler_map())
+		{
+			const key_type offset = offset_of(key_value_pair.second.first);
+			checksum = util::fnv1a(reinterpret_cast<const char*>(&offset), sizeof offset, checksum);
+		}
+	}
+
+	static handler_type get_handler(key_type key)
+	{
+		if (is_direct())
+			return reinterpret_cast<handler_type>(anchor_address() + key);
+		return msg_handler_registry_abi::get_handler(key);
+	}
+
+	template<class Msg>
+	static key_type register_handler() {
+		return msg_handler_registry_abi::register_handler<Msg>();
+	}
+
+	// a hash of all relative handler addresses, that is the same for identical binaries
+	static uint64_t offsets_checksum() { return get_offsets_checksum(); }
+
+	// switches to relative addresses as keys
+	// NOTE: must be called on all nodes, while no messages are in flight
+	static void enable_direct()
+	{
+		for (auto& key_value_pair : get_handler_map())
+			key_value_pair.second.second(offset_of(key_value_pair.second.first)); // this actually calls active_msg::set_handler_key()
+		get_direct() = true;
+	}
+
+	static bool is_direct() { return get_direct(); }
+
+protected:
+	static void anchor(void*) { }
+
+	static uintptr_t anchor_address() { return reinterpret_cast<uintptr_t>(&anchor); }
+
+	// NOTE: unsigned wrap around, if handler is below anchor()
+	static key_type offset_of(handler_type handler) { return reinterpret_cast<uintptr_t>(handler) - anchor_address(); }
+
+	static bool& get_direct() {
+		static bool direct = false;
+		return direct;
+	}
+
+	static uint64_t& get_offsets_checksum() {
+		static uint64_t checksum = 0;
+		return checksum;
+	}
+};
+
+} // namespace msg
+} // namespace ham
+
+#endif // ham_msg_msg_handler_registry_direct_hpp
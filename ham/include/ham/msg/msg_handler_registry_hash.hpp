@@ -0,0 +1,188 @@
+// Copyright (c) 2013-2026 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ham_msg_msg_handler_registry_hash_hpp
+#define ham_msg_msg_handler_registry_hash_hpp
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <ostream>
+#include <vector>
+
+#include "ham/util/hash.hpp"
+#include "ham/util/log.hpp"
+
+namespace ham {
+namespace msg {
+
+/**
+ * Implementation of the msg_handler_registry concept, that uses a hash of
+ * the type name as key, which is computed at compile time.
+ * The type name is taken from __PRETTY_FUNCTION__, which is the same for all
+ * binaries generated from the same source by the same compiler. Binaries
+ * from different compilers need msg_handler_registry_abi.
+ *
+ * On static data initialisation, each message type appends its key and
+ * handler address to a vector. Nothing needs to be patched afterwards, since
+ * each message type knows its key from the beginning.
+ * When init() is called (in the programme's main function), the keys are
+ * checked for collisions, and inserted into an open addressing hash table
+ * (linear probing) with at least twice as many slots as handlers. On the
+ * remote side, the key is used to get the handler from the table in O(1).
+ *
+ * checksum() is a hash of all keys, that allows a fast check whether two
+ * binaries have the same handlers.
+ *
+ * This class is a monostate (i.e. everything is static).
+ */
+class msg_handler_registry_hash {
+public:
+	using key_type = uint64_t;
+	using handler_type = void (*)(void*);
+
+	static void init()
+	{
+		std::vector<entry>& entries = get_entries();
+		std::sort(entries.begin(), entries.end(), [](const entry& a, const entry& b) { return a.key < b.key; });
+		for (size_t i = 1; i < entries.size(); ++i) {
+			if (entries[i].key == entries[i - 1].key) {
+				HAM_LOG << "msg_handler_registry_hash::init(): error: key collision of " << entries[i - 1].name << " and " << entries[i].name << ", please use another message handler registry." << std::endl;
+				exit(EXIT_FAILURE);
+			}
+		}
+
+		size_t slots = 16;
+		while (slots < 2 * entries.size())
+			slots *= 2;
+		std::vector<entry>& table = get_table();
+		table.assign(slots, entry { INVALID_KEY_VALUE, nullptr, nullptr });
+		get_mask() = slots - 1;
+		for (const entry& e : entries) {
+			size_t slot = e.key & get_mask();
+			while (table[slot].key != INVALID_KEY_VALUE)
+				slot = (slot + 1) & get_mask();
+			table[slot] = e;
+		}
+
+		key_type& checksum = get_checksum();
+		checksum = util::FNV1A_OFFSET_BASIS;
+		for (const entry& e : entries)
+			checksum = util::fnv1a(reinterpret_cast<const char*>(&e.key), sizeof e.key, checksum);
+	}
+
+	static handler_type get_handler(key_type key)
+	{
+		const std::vector<entry>& table = get_table();
+		size_t slot = key & get_mask();
+		while (table[slot].key != key) {
+			if (table[slot].key == INVALID_KEY_VALUE)
+				unknown_key(key);
+			slot = (slot + 1) & get_mask();
+		}
+		return table[slot].handler;
+	}
+
+	template<class Msg>
+	static key_type register_handler() {
+		static_assert(key_of<Msg>() != INVALID_KEY_VALUE, "message key collides with INVALID_KEY_VALUE");
+		get_entries().push_back(entry { key_of<Msg>(), &Msg::handler, name<Msg>() });
+		return key_of<Msg>();
+	}
+
+	// the number of handlers, and a hash of their keys, that are the same for compatible binaries
+	static size_t size() { return get_entries().size(); }
+	static key_type checksum() { return get_checksum(); }
+
+	static void print_handler_map(std::ostream& out)
+	{
+		out << "==================== BEGIN HANDLER MAP =====================" << std::endl;
+		for (const entry& e : get_entries())
+		{
+			out << "key: " << e.key << ",\t"
+			    << "name: " << e.name << ",\t"
+			    << "handler_address: " << e.handler << std::endl;
+		}
+		out << "==================== END HANDLER MAP =======================" << std::endl;
+	}
+
+	static void print_handler_vector(std::ostream& out)
+	{
+		const std::vector<entry>& table = get_table();
+		out << "==================== BEGIN HANDLER TABLE ===================" << std::endl;
+		for (size_t i = 0; i < table.size(); ++i)
+		{
+			if (table[i].key == INVALID_KEY_VALUE)
+				continue;
+			out << "slot: " << i << ",\t"
+			    << "key: " << table[i].key << ",\t"
+			    << "handler_address: " << table[i].handler << std::endl;
+		}
+		out << "==================== END HANDLER TABLE =====================" << std::endl;
+	}
+
+protected:
+	struct entry {
+		key_type key;
+		handler_type handler;
+		const char* name; // for diagnostics
+	};
+
+	// NOTE: __PRETTY_FUNCTION__ contains Msg, the key is a constant expression
+	template<class Msg>
+	static constexpr key_type key_of()
+	{
+		return util::fnv1a(__PRETTY_FUNCTION__, sizeof(__PRETTY_FUNCTION__) - 1);
+	}
+
+	template<class Msg>
+	static const char* name()
+	{
+		return __PRETTY_FUNCTION__;
+	}
+
+	static void unknown_key(key_type key)
+	{
+		HAM_LOG << "msg_handler_registry_hash::get_handler(): error: unknown key " << key << ", the binaries of host and targets do not match." << std::endl;
+		exit(EXIT_FAILURE);
+	}
+
+	/**
+	 * "Construct On First Use"-idiom.
+	 * All registered handlers, filled prior to main when
+	 * active_msg::handler_key_static is initialised.
+	 */
+	static std::vector<entry>& get_entries() {
+		static std::vector<entry> entries;
+		return entries;
+	}
+
+	/**
+	 * "Construct On First Use"-idiom.
+	 * Hash table of all handlers, filled by init().
+	 */
+	static std::vector<entry>& get_table() {
+		static std::vector<entry> table;
+		return table;
+	}
+
+	static size_t& get_mask() {
+		static size_t mask = 0;
+		return mask;
+	}
+
+	static key_type& get_checksum() {
+		static key_type checksum = 0;
+		return checksum;
+	}
+
+	static constexpr key_type INVALID_KEY_VALUE { std::numeric_limits<key_type>::max() };
+};
+
+} // namespace msg
+} // namespace ham
+
+#endif // ham_msg_msg_handler_registry_hash_hpp
@@ -0,0 +1,110 @@
+// Copyright (c) 2013-2026 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ham_msg_worker_pool_hpp
+#define ham_msg_worker_pool_hpp
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ham/util/debug.hpp"
+#include "ham/util/log.hpp"
+
+namespace ham {
+namespace msg {
+
+/**
+ * Worker threads of a receiving node, that execute the messages with
+ * execution_policy_pool, so that the receiving thread can continue to
+ * receive and execute other messages meanwhile.
+ * Tasks are executed in FIFO order by any of the workers, i.e. concurrently.
+ */
+class worker_pool {
+public:
+	using task_function = void (*)(void*);
+
+	// init_worker is called by each worker thread before it executes any task
+	worker_pool(size_t threads, std::function<void()> init_worker)
+	{
+		for (size_t i = 0; i < threads; ++i)
+			workers.emplace_back([this, init_worker]() {
+				if (init_worker)
+					init_worker();
+				run();
+			});
+		HAM_DEBUG( HAM_LOG << "worker_pool::worker_pool(): started " << threads << " worker threads" << std::endl; )
+	}
+
+	worker_pool(const worker_pool&) = delete;
+	worker_pool& operator=(const worker_pool&) = delete;
+
+	// executes the remaining tasks, and joins the workers
+	~worker_pool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		ready.notify_all();
+		for (auto& worker : workers)
+			worker.join();
+	}
+
+	void submit(task_function function, void* data)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			tasks.push_back(task { function, data });
+		}
+		ready.notify_one();
+	}
+
+	size_t size() const { return workers.size(); }
+
+	// the pool of the calling receiving thread, nullptr if messages are executed by the receiving thread itself
+	static worker_pool*& current()
+	{
+		static thread_local worker_pool* pool = nullptr;
+		return pool;
+	}
+
+private:
+	struct task {
+		task_function function;
+		void* data;
+	};
+
+	void run()
+	{
+		for (;;) {
+			task t;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				ready.wait(lock, [this]() { return stopping || !tasks.empty(); });
+				if (tasks.empty()) // stopping
+					return;
+				t = tasks.front();
+				tasks.pop_front();
+			}
+			t.function(t.data);
+		}
+	}
+
+	std::mutex mutex;
+	std::condition_variable ready;
+	std::deque<task> tasks;
+	bool stopping = false;
+	std::vector<std::thread> workers;
+};
+
+} // namespace msg
+} // namespace ham
+
+#endif // ham_msg_worker_pool_hpp
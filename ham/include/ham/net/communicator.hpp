@@ -37,18 +37,47 @@ namespace net {
 	{
 		char data[constants::MSG_SIZE];
 	};
+
+	// the part of a request, that the receiver of a message needs for sending back the result,
+	// messages carry this instead of the whole request, see request::reply() and communicator::send_result()
+	struct reply_descriptor
+	{
+		enum : uint32_t { NO_REPLY = UINT32_MAX }; // the sender does not expect a result
+
+		node_t source_node; // the sender of the message
+		uint32_t source_buffer_index; // where the sender expects the result
+
+		bool valid() const { return source_buffer_index != NO_REPLY; }
+	};
 	
 	node_t this_node();
 	bool initialised();
 } // namespace net
 } // namespace ham
 
-// NOTE: include new communication backends here, define HAM_COMM_ONE_SIDED accordingly
+// NOTE: include new communication backends here, define HAM_COMM_ONE_SIDED accordingly,
+//       and HAM_COMM_TARGET_TRANSFERS if offload targets can transfer data between each other (send_data(), recv_data())
+//       and HAM_COMM_PEER_OFFLOAD if offload targets can offload to each other (i.e. send messages to, and receive messages from, other targets)
 #ifdef HAM_COMM_MPI
-	#include "ham/net/communicator_mpi.hpp"
+	#define HAM_COMM_TARGET_TRANSFERS
+	#ifdef HAM_COMM_MPI_RMA // MPI-3 one-sided variant
+		#define HAM_COMM_ONE_SIDED
+		#include "ham/net/communicator_mpi_rma.hpp"
+	#else
+		#define HAM_COMM_PEER_OFFLOAD
+		#include "ham/net/communicator_mpi.hpp"
+	#endif
 #elif defined HAM_COMM_SCIF
 	#define HAM_COMM_ONE_SIDED
 	#include "ham/net/communicator_scif.hpp"
+#elif defined HAM_COMM_SHM
+	#define HAM_COMM_ONE_SIDED
+	#define HAM_COMM_TARGET_TRANSFERS
+	#include "ham/net/communicator_shm.hpp"
+#elif defined HAM_COMM_THREADS
+	#define HAM_COMM_ONE_SIDED
+	#define HAM_COMM_TARGET_TRANSFERS
+	#include "ham/net/communicator_threads.hpp"
 #elif defined HAM_COMM_VEO
 	#define HAM_COMM_ONE_SIDED
 	#if (HAM_COMM_VEO == 0) // vector host
@@ -72,7 +101,7 @@ namespace net {
 		static_assert(false, "HAM_COMM_VEDMA must be set to 0 (vector host build) or 1 (vector engine build).");
 	#endif
 #else	
-	static_assert(false, "Please define either HAM_COMM_MPI, or HAM_COMM_SCIF.");
+	static_assert(false, "Please define one of HAM_COMM_MPI, HAM_COMM_SCIF, HAM_COMM_SHM, HAM_COMM_THREADS, HAM_COMM_VEO, or HAM_COMM_VEDMA.");
 #endif
 
 #endif // ham_net_communicator_hpp
@@ -12,6 +12,7 @@
 #include <cstring> // memcpy
 #include <cstdlib> // posix_memalign
 #include <cerrno> // posix_memalign returns
+#include <mutex>
 
 #include "ham/misc/constants.hpp"
 #include "ham/misc/options.hpp"
@@ -94,17 +95,13 @@ public:
 			HAM_DEBUG( HAM_LOG << "request::get(), before MPI_Waitall()" << std::endl; )
 			MPI_Waitall(req_count, mpi_reqs, MPI_STATUS_IGNORE); // must wait for all requests to satisfy the standard
 			HAM_DEBUG( HAM_LOG << "request::get(), after MPI_Waitall()" << std::endl; )
-			return static_cast<void*>(&communicator::instance().peers[target_node].msg_buffers[source_buffer_index]);
+			return communicator::instance().peer_msg_buffer(target_node, source_buffer_index);
 		}
 
-		template<class T>
-		void send_result(T* result_msg, size_t size)
+		// the compact part of this request, that is sent along with a message, see communicator::send_result()
+		reply_descriptor reply() const
 		{
-			assert(communicator::this_node() == target_node); // this assert fails if send_result is called from the wrong side
-			
-			// TODO(improvement, low priority): better go through communicator, such that no MPI calls are anywhere else
-			MPI_Send(result_msg, size, MPI_BYTE, source_node, constants::RESULT_TAG, MPI_COMM_WORLD);
-			//communicator::instance().send_msg(source_node, source_buffer_index, NO_BUFFER_INDEX, result_msg, size);
+			return { source_node, valid() ? static_cast<uint32_t>(source_buffer_index) : static_cast<uint32_t>(reply_descriptor::NO_REPLY) };
 		}
 
 		bool valid() const
@@ -158,6 +155,21 @@ public:
 		nodes_ = static_cast<size_t>(t);
 		host_node_ = 0; // TODO(improvement): make configureable, like for SCIF
 
+		// message buffer configuration, the host's values are used everywhere
+		unsigned long long msg_config[2] = { comm_options.msg_size(), comm_options.msg_buffers() };
+		MPI_Bcast(msg_config, 2, MPI_UNSIGNED_LONG_LONG, host_node_, MPI_COMM_WORLD);
+		msg_size = static_cast<size_t>(msg_config[0]);
+		msg_buffers = static_cast<size_t>(msg_config[1]);
+
+		// the per-request tags must be valid MPI tags
+		int* tag_ub = nullptr;
+		int flag = 0;
+		MPI_Comm_get_attr(MPI_COMM_WORLD, MPI_TAG_UB, &tag_ub, &flag);
+		if (flag && static_cast<size_t>(*tag_ub) < constants::RESULT_TAG_BASE + (1 + nodes_) * msg_buffers) { // see data_tag()
+			HAM_LOG << "communicator::communicator(): error: --ham-msg-buffers " << msg_buffers << " exceeds the MPI tag range (MPI_TAG_UB = " << *tag_ub << ")" << std::endl;
+			MPI_Abort(MPI_COMM_WORLD, 1);
+		}
+
 		instance_ = this; // NOTE: this also marks the communicator as initialised, e.g. important for calls to this_node()
 		HAM_DEBUG( std::cout << "communicator::communicator(): initialising MPI done" << std::endl; )
 
@@ -189,19 +201,51 @@ public:
 		
 		if (is_host()) {
 			for (size_t i = 1; i < nodes_; ++i) { // TODO(improvement): needs to be changed when host-rank becomes configurable
-				node_t current_node = static_cast<node_t>(i);
-				// allocate buffers
-				peers[current_node].msg_buffers = allocate_buffer<msg_buffer>(constants::MSG_BUFFERS, this_node_);
-				// fill resource pools
-				for (size_t j = constants::MSG_BUFFERS; j > 0; --j) {
-					peers[current_node].buffer_pool.add(j - 1);
-				}
+				peer(static_cast<node_t>(i)); // NOTE: the host sets up all targets, offload targets set up other targets on first use
+			}
+		} else {
+			// pre-post a ring of persistent receives for messages from the host and the other targets, see recv_msg_host()
+			recv_ring_buffers = allocate_buffer<char>(constants::RECV_RING_SIZE * msg_size, this_node_).get();
+			for (size_t j = 0; j < constants::RECV_RING_SIZE; ++j) {
+				MPI_Recv_init(static_cast<void*>(recv_ring_buffers + j * msg_size), msg_size, MPI_BYTE, MPI_ANY_SOURCE, constants::DEFAULT_TAG, MPI_COMM_WORLD, &recv_ring_requests[j]);
+			}
+			MPI_Startall(constants::RECV_RING_SIZE, recv_ring_requests);
+
+			// buffers for non-blocking result sends, see send_result()
+			result_send_buffers = allocate_buffer<char>(constants::RESULT_SENDS * msg_size, this_node_).get();
+			for (size_t j = constants::RESULT_SENDS; j > 0; --j) {
+				result_send_requests[j - 1] = MPI_REQUEST_NULL;
+				result_send_pool.add(j - 1);
 			}
 		}
+
+		if (comm_options.print_footprint() && (is_host() || this_node_ == 1)) {
+			const size_t footprint = is_host() ? msg_buffers * msg_size : (constants::RECV_RING_SIZE + constants::RESULT_SENDS) * msg_size;
+			HAM_LOG << "communicator: " << msg_buffers << " message buffers of " << msg_size << " B per peer, " << (is_host() ? "host" : "target") << " footprint per peer: " << footprint << " B" << std::endl;
+		}
 	}
 
 	~communicator()
 	{
+		for (size_t i = 0; i < nodes_; ++i)
+			free(static_cast<void*>(peers[i].msg_buffers)); // NOTE: nullptr for peers that were never used
+		delete [] peers;
+
+		if (!is_host()) {
+			// NOTE: all but the slot of the last (terminating) message are still active
+			for (size_t j = 0; j < constants::RECV_RING_SIZE; ++j) {
+				if (j != recv_ring_current) {
+					MPI_Cancel(&recv_ring_requests[j]);
+					MPI_Wait(&recv_ring_requests[j], MPI_STATUS_IGNORE);
+				}
+				MPI_Request_free(&recv_ring_requests[j]);
+			}
+			free(static_cast<void*>(recv_ring_buffers));
+
+			// complete all outstanding result sends
+			MPI_Waitall(constants::RESULT_SENDS, result_send_requests, MPI_STATUSES_IGNORE);
+			free(static_cast<void*>(result_send_buffers));
+		}
 		MPI_Finalize(); // TODO(improvement): check on error and create output if there was one
 		HAM_DEBUG( HAM_LOG << "~communicator" << std::endl; )
 	}
@@ -211,8 +255,25 @@ public:
 	{
 		HAM_DEBUG( HAM_LOG << "communicator::allocate_next_request(): remote_node = " << remote_node << std::endl; )
 
-		const size_t target_buffer_index = peers[remote_node].buffer_pool.allocate();
-		const size_t source_buffer_index = peers[remote_node].buffer_pool.allocate();
+		mpi_peer& remote_peer = peer(remote_node);
+		const size_t target_buffer_index = remote_peer.buffer_pool.allocate();
+		const size_t source_buffer_index = remote_peer.buffer_pool.allocate();
+
+		return { remote_node, this_node_, target_buffer_index, source_buffer_index };
+	}
+
+	// like allocate_request(), but returns an invalid request instead of over-allocating, if all buffers to remote_node are in use
+	request try_allocate_request(node_t remote_node)
+	{
+		mpi_peer& remote_peer = peer(remote_node);
+		size_t target_buffer_index = 0;
+		size_t source_buffer_index = 0;
+		if (!remote_peer.buffer_pool.try_allocate(target_buffer_index))
+			return request();
+		if (!remote_peer.buffer_pool.try_allocate(source_buffer_index)) {
+			remote_peer.buffer_pool.free(target_buffer_index);
+			return request();
+		}
 
 		return { remote_node, this_node_, target_buffer_index, source_buffer_index };
 	}
@@ -230,57 +291,121 @@ public:
 	}
 
 public:
+	// two-phase send, 1st step: returns the transfer buffer belonging to req, in which the message can be constructed in place
+	void* reserve_msg_buffer(request_reference_type req)
+	{
+		return peer_msg_buffer(req.target_node, req.target_buffer_index);
+	}
+
+	// two-phase send, 2nd step: sends size bytes of the message constructed inside reserve_msg_buffer(req)
+	void commit_msg(request_reference_type req, size_t size)
+	{
+		MPI_Isend(reserve_msg_buffer(req), size, MPI_BYTE, req.target_node, constants::DEFAULT_TAG, MPI_COMM_WORLD, &req.next_mpi_request());
+	}
+
 	void send_msg(request_reference_type req, void* msg, size_t size)
 	{
 		// copy message from caller into transfer buffer
-		void* msg_buffer = static_cast<void*>(&peers[req.target_node].msg_buffers[req.target_buffer_index]);
-		memcpy(msg_buffer, msg, size);
-		MPI_Isend(msg_buffer, size, MPI_BYTE, req.target_node, constants::DEFAULT_TAG, MPI_COMM_WORLD, &req.next_mpi_request());
+		memcpy(reserve_msg_buffer(req), msg, size);
+		commit_msg(req, size);
 	}
 	
-	// to be used by the offload target's main loop: synchronously receive one message at a time
-	// NOTE: the local static receive buffer!
-	void* recv_msg_host(void* msg = nullptr, size_t size = constants::MSG_SIZE)
+	// to be used by the offload target's main loop: receive one message at a time from the ring of pre-posted receives,
+	// which accept messages from the host and the other targets (MPI_ANY_SOURCE), see HAM_COMM_PEER_OFFLOAD
+	// NOTE: the returned buffer is valid until the next call, its receive is re-posted then
+	//       MPI matches incoming messages to the receives in posting order, so the ring slots complete in posting order,
+	//       and the non-overtaking rule keeps the messages from each sender in order
+	void* recv_msg_host(void* msg = nullptr, size_t size = 0)
 	{
 		HAM_UNUSED_VAR(msg);
-		static msg_buffer buffer; // NOTE !
-		MPI_Recv(&buffer, size, MPI_BYTE, host_node_, constants::DEFAULT_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-		return static_cast<void*>(&buffer);
+		HAM_UNUSED_VAR(size); // NOTE: the ring receives always use msg_size
+
+		// re-post the slot of the previous message, which has been handled by now
+		if (recv_ring_current != NO_RING_SLOT) {
+			MPI_Start(&recv_ring_requests[recv_ring_current]);
+			recv_ring_current = (recv_ring_current + 1) % constants::RECV_RING_SIZE;
+		} else {
+			recv_ring_current = 0;
+		}
+
+		MPI_Wait(&recv_ring_requests[recv_ring_current], MPI_STATUS_IGNORE);
+		return static_cast<void*>(recv_ring_buffers + recv_ring_current * msg_size);
 	}
 
-	// trigger receiving the result of a message on the sending side
-	void recv_result(request_reference_type req)
+	// to be used by offload targets: non-blocking send of a result message, the result is copied into a send buffer,
+	// so the caller can continue immediately, buffers of completed sends are reclaimed lazily when the pool runs empty
+	// sends the result of a message back to its sender, called by the receiver of the message
+	// NOTE: thread-safe, for the workers of execution_policy_pool
+	void send_result(const reply_descriptor& reply, void* result_msg, size_t size)
 	{
-		// nothing todo here, since this communicator implementation uses one-sided communication
-		// the data is already where it is expected (in the buffer referenced in req)
-		MPI_Irecv(static_cast<void*>(&peers[req.target_node].msg_buffers[req.source_buffer_index]), constants::MSG_SIZE, MPI_BYTE, req.target_node, constants::RESULT_TAG, MPI_COMM_WORLD, &req.next_mpi_request());
+		assert(reply.valid());
+		std::lock_guard<std::mutex> lock(result_send_mutex);
+		const int tag = constants::RESULT_TAG_BASE + static_cast<int>(reply.source_buffer_index); // see result_tag()
+		if (result_send_pool.empty())
+			reclaim_result_sends();
+
+		const size_t index = result_send_pool.allocate();
+		void* buffer = static_cast<void*>(result_send_buffers + index * msg_size);
+		memcpy(buffer, result_msg, size);
+		MPI_Isend(buffer, size, MPI_BYTE, reply.source_node, tag, MPI_COMM_WORLD, &result_send_requests[index]);
+	}
+
+private:
+	// returns the buffers of all completed result sends to the pool, blocks until there is at least one
+	void reclaim_result_sends()
+	{
+		int count = 0;
+		int indices[constants::RESULT_SENDS];
+		MPI_Testsome(constants::RESULT_SENDS, result_send_requests, &count, indices, MPI_STATUSES_IGNORE);
+		if (count == 0)
+			MPI_Waitsome(constants::RESULT_SENDS, result_send_requests, &count, indices, MPI_STATUSES_IGNORE);
+		HAM_DEBUG( HAM_LOG << "communicator::reclaim_result_sends(): reclaimed " << count << " buffers" << std::endl; )
+
+		for (int i = 0; i < count; ++i)
+			result_send_pool.free(static_cast<size_t>(indices[i])); // NOTE: the completed requests were set to MPI_REQUEST_NULL
+	}
+
+public:
+	// trigger receiving the result of size byte on the sending side
+	// NOTE: the receive is posted for the exact size of the result, which is what the target sends
+	void recv_result(request_reference_type req, size_t size)
+	{
+		assert(size <= msg_size);
+		MPI_Irecv(peer_msg_buffer(req.target_node, req.source_buffer_index), size, MPI_BYTE, req.target_node, result_tag(req), MPI_COMM_WORLD, &req.next_mpi_request());
+	}
+
+	// like above, but the result is received into dest instead of the message buffer, e.g. the data of a small get()
+	void recv_result(request_reference_type req, void* dest, size_t size)
+	{
+		assert(size <= msg_size);
+		MPI_Irecv(dest, size, MPI_BYTE, req.target_node, result_tag(req), MPI_COMM_WORLD, &req.next_mpi_request());
 	}
 
 	template<typename T>
-	void send_data(T* local_source, buffer_ptr<T> remote_dest, size_t size)
+	void send_data(T* local_source, buffer_ptr<T> remote_dest, size_t size, int tag = constants::DATA_TAG)
 	{
-		MPI_Send((void*)local_source, size * sizeof(T), MPI_BYTE, remote_dest.node(), constants::DATA_TAG, MPI_COMM_WORLD);
+		MPI_Send((void*)local_source, size * sizeof(T), MPI_BYTE, remote_dest.node(), tag, MPI_COMM_WORLD);
 	}
 
 	// to be used by the host
 	template<typename T>
 	void send_data_async(request_reference_type req, T* local_source, buffer_ptr<T> remote_dest, size_t size)
 	{
-		MPI_Isend((void*)local_source, size * sizeof(T), MPI_BYTE, remote_dest.node(), constants::DATA_TAG, MPI_COMM_WORLD, &req.next_mpi_request());
+		MPI_Isend((void*)local_source, size * sizeof(T), MPI_BYTE, remote_dest.node(), data_tag(req), MPI_COMM_WORLD, &req.next_mpi_request());
 	}
 
 
 	template<typename T>
-	void recv_data(buffer_ptr<T> remote_source, T* local_dest, size_t size)
+	void recv_data(buffer_ptr<T> remote_source, T* local_dest, size_t size, int tag = constants::DATA_TAG)
 	{
-		MPI_Recv((void*)local_dest, size * sizeof(T), MPI_BYTE, remote_source.node(), constants::DATA_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+		MPI_Recv((void*)local_dest, size * sizeof(T), MPI_BYTE, remote_source.node(), tag, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
 	}
 	
 	// to be used by the host
 	template<typename T>
 	void recv_data_async(request_reference_type req, buffer_ptr<T> remote_source, T* local_dest, size_t size)
 	{
-		MPI_Irecv(static_cast<void*>(local_dest), size * sizeof(T), MPI_BYTE, remote_source.node(), constants::DATA_TAG, MPI_COMM_WORLD, &req.next_mpi_request());
+		MPI_Irecv(static_cast<void*>(local_dest), size * sizeof(T), MPI_BYTE, remote_source.node(), data_tag(req), MPI_COMM_WORLD, &req.next_mpi_request());
 	}
 
 	template<typename T>
@@ -317,6 +442,24 @@ public:
 		free(static_cast<void*>(ptr.get()));
 	}
 
+	// per-request tags, source_buffer_index is unique among the in-flight requests to a peer
+	static int result_tag(request_const_reference_type req) { return constants::RESULT_TAG_BASE + static_cast<int>(req.source_buffer_index); }
+	// NOTE: data transfers between two nodes may be initiated by either of them, or by a third node (see offload::copy_async()),
+	//       so each initiating node (source_node of the request) has its own range of data tags behind the result tags
+	static int data_tag(request_const_reference_type req) { return constants::RESULT_TAG_BASE + static_cast<int>((1 + req.source_node) * instance().msg_buffers + req.source_buffer_index); }
+
+	// size of the message buffers, see --ham-msg-size
+	static size_t max_msg_size() { return instance().msg_size; }
+
+	// number of message buffers per peer, see --ham-msg-buffers
+	static size_t num_msg_buffers() { return instance().msg_buffers; }
+
+	// the buffer with index buffer_index among the message buffers used for sending to node
+	void* peer_msg_buffer(node_t node, size_t buffer_index)
+	{
+		return static_cast<void*>(peers[node].msg_buffers + buffer_index * msg_size);
+	}
+
 	static communicator& instance() { return *instance_; }
 	static bool initialised() { return instance_ != nullptr; };
 	static node_t this_node() { return instance().this_node_; }
@@ -336,15 +479,48 @@ private:
 	node_t host_node_;
 	std::vector<node_descriptor> node_descriptions; // not as member in peer below, because Allgather is used to exchange node descriptions
 		
+	size_t msg_size; // size of each message buffer
+	size_t msg_buffers; // number of message buffers per peer
+
 	struct mpi_peer {
-		buffer_ptr<msg_buffer> msg_buffers; // buffers used for MPI_ISend and IRecv by the sender
+		char* msg_buffers = nullptr; // msg_buffers buffers of msg_size used for MPI_ISend and IRecv by the sender
 
 		// needed by sender to manage which buffers are in use and which are free
 		// just manages indices, that can be used by
 		detail::resource_pool<size_t> buffer_pool;
+
+		std::once_flag setup; // see peer()
 	};
 	
 	mpi_peer* peers;
+
+	// the state for sending messages to node, which is set up on first use
+	// NOTE: thread-safe, e.g. for offloading from the workers of a target, see execution_policy_pool
+	mpi_peer& peer(node_t node)
+	{
+		mpi_peer& p = peers[node];
+		std::call_once(p.setup, [this, &p]() {
+			// allocate buffers
+			p.msg_buffers = allocate_buffer<char>(msg_buffers * msg_size, this_node_).get();
+			// fill resource pools
+			for (size_t j = msg_buffers; j > 0; --j) {
+				p.buffer_pool.add(j - 1);
+			}
+		});
+		return p;
+	}
+
+	// ring of persistent receives for messages from the host, only used by offload targets
+	enum { NO_RING_SLOT = constants::RECV_RING_SIZE };
+	char* recv_ring_buffers = nullptr; // RECV_RING_SIZE buffers of msg_size
+	MPI_Request recv_ring_requests[constants::RECV_RING_SIZE];
+	size_t recv_ring_current = NO_RING_SLOT; // slot of the message currently handled
+
+	// non-blocking result sends, only used by offload targets
+	char* result_send_buffers = nullptr; // RESULT_SENDS buffers of msg_size
+	MPI_Request result_send_requests[constants::RESULT_SENDS];
+	detail::resource_pool<size_t> result_send_pool;
+	std::mutex result_send_mutex; // see send_result()
 };
 
 template<typename T>
@@ -0,0 +1,522 @@
+// Copyright (c) 2013-2019 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ham_net_communicator_mpi_rma_hpp
+#define ham_net_communicator_mpi_rma_hpp
+
+#include <mutex>
+#include <mpi.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring> // memcpy
+#include <cstdlib> // posix_memalign
+#include <cerrno> // posix_memalign returns
+#include <vector>
+
+#include "ham/misc/constants.hpp"
+#include "ham/misc/options.hpp"
+#include "ham/misc/resource_pool.hpp"
+#include "ham/misc/types.hpp"
+#include "ham/util/debug.hpp"
+#include "ham/util/log.hpp"
+
+namespace ham {
+namespace net {
+
+template<typename T>
+class buffer_ptr {
+public:
+	buffer_ptr();
+	buffer_ptr(T* ptr, node_t node) : ptr_(ptr), node_(node) { }
+
+	T* get() const { return ptr_; }
+	node_t node() const { return node_; }
+
+	// element access
+	T& operator [] (size_t i);
+
+	// basic pointer arithmetic to address sub-buffers
+	buffer_ptr<T> operator+(size_t off)
+	{
+		return buffer_ptr(ptr_ + off, node_);
+	}
+
+private:
+	T* ptr_; // address inside the address space of node_, attached to the data window there
+	node_t node_;
+};
+
+class node_descriptor
+{
+public:
+	const char* name() const { return name_; }
+private:
+	char name_[MPI_MAX_PROCESSOR_NAME + 1];
+
+	friend class net::communicator;
+};
+
+class communicator_options : public ham::detail::options
+{
+public:
+	communicator_options(int* argc_ptr, char** argv_ptr[]) : options(argc_ptr, argv_ptr)
+	{
+		// NOTE: no further inheritance or adding
+		parse();
+	}
+};
+
+// NOTE: this communicator implements the one-sided flag protocol of the SCIF communicator on top of MPI-3 RMA
+//       every process exposes a mailbox window (MPI_Win_allocate) with message buffers and flags,
+//       messages are written via MPI_Put followed by a flag, the receiver polls on its local flags
+//       buffers from allocate_buffer() are attached to a dynamic window, so put/get become MPI_Put/MPI_Get
+//       without any involvement of the target's receive loop
+//       all windows are locked once (MPI_Win_lock_all) for the whole runtime, completion is done via MPI_Win_flush
+class communicator {
+public:
+	// NOTE: the number of buffers is only known at runtime, so the special values are taken from the top of the index range
+	enum : size_t {
+		NO_BUFFER_INDEX = SIZE_MAX - 1, // invalid buffer index
+		FLAG_FALSE = SIZE_MAX // special value, outside normal index range
+	};
+
+	// externally used interface of request must be shared across all communicator-implementations
+	struct request {
+
+		request() : target_buffer_index(NO_BUFFER_INDEX) {} // instantiate invalid
+		request(node_t target_node, size_t target_buffer_index, node_t source_node, size_t source_buffer_index)
+		 : target_node(target_node), target_buffer_index(target_buffer_index), source_node(source_node), source_buffer_index(source_buffer_index)
+		{}
+
+		bool test() const
+		{
+			return communicator::instance().test_local_flag(target_node, source_buffer_index);
+		}
+
+		void* get() const // blocks
+		{
+			return communicator::instance().recv_msg(target_node, source_buffer_index); // we wait for the remote side, to write into our buffer/flag
+		}
+
+		// the compact part of this request, that is sent along with a message, see communicator::send_result()
+		reply_descriptor reply() const
+		{
+			return { source_node, valid() ? static_cast<uint32_t>(source_buffer_index) : static_cast<uint32_t>(reply_descriptor::NO_REPLY) };
+		}
+
+		bool valid() const
+		{
+			return target_buffer_index != NO_BUFFER_INDEX;
+		}
+
+		node_t target_node;
+		size_t target_buffer_index; // for sending to target node
+		node_t source_node;
+		size_t source_buffer_index; // for receiving from target node
+	};
+
+	typedef request& request_reference_type;
+	typedef const request& request_const_reference_type;
+
+	communicator(communicator_options& comm_options)
+	{
+		HAM_DEBUG( HAM_LOG << "communicator::communicator(): initialising MPI" << std::endl; )
+
+		int p;
+		MPI_Init_thread(comm_options.argc_ptr(), comm_options.argv_ptr(), MPI_THREAD_MULTIPLE, &p);
+		if (p != MPI_THREAD_MULTIPLE)
+		{
+			HAM_LOG << "Could not initialise MPI with MPI_THREAD_MULTIPLE, MPI_Init_thread() returned " << p << std::endl;
+		}
+
+		int t;
+		MPI_Comm_rank(MPI_COMM_WORLD, &t);
+		this_node_ = static_cast<node_t>(t);
+		MPI_Comm_size(MPI_COMM_WORLD, &t);
+		nodes_ = static_cast<size_t>(t);
+		host_node_ = 0; // TODO(improvement): make configureable, like for SCIF
+
+		// message buffer configuration, the host's values are used everywhere
+		unsigned long long msg_config[2] = { comm_options.msg_size(), comm_options.msg_buffers() };
+		MPI_Bcast(msg_config, 2, MPI_UNSIGNED_LONG_LONG, host_node_, MPI_COMM_WORLD);
+		msg_size = static_cast<size_t>(msg_config[0]);
+		msg_buffers = static_cast<size_t>(msg_config[1]);
+
+		instance_ = this; // NOTE: this also marks the communicator as initialised, e.g. important for calls to this_node()
+
+		HAM_DEBUG( HAM_LOG << "FLAG_FALSE = " << FLAG_FALSE << ", NO_BUFFER_INDEX = " << NO_BUFFER_INDEX << std::endl; )
+
+		peers = new rma_peer[nodes_];
+
+		// exchange node descriptors
+		node_descriptions.resize(nodes_);
+		node_descriptor node_description;
+		int count;
+		MPI_Get_processor_name(node_description.name_, &count);
+		node_description.name_[count] = 0x0; // null terminate
+		MPI_Allgather(&node_description, sizeof(node_descriptor), MPI_BYTE, node_descriptions.data(), sizeof(node_descriptor), MPI_BYTE, MPI_COMM_WORLD);
+
+		// mailbox window: the host has one region per target, targets have a single region for the host
+		const size_t regions = is_host() ? nodes_ - 1 : 1;
+		char* mailbox = nullptr;
+		MPI_Win_allocate(regions * region_size(), 1, MPI_INFO_NULL, MPI_COMM_WORLD, &mailbox, &mailbox_win);
+
+		for (node_t i = 0; i < static_cast<node_t>(nodes_); ++i)
+		{
+			// NOTE: targets only communicate with the host
+			if (i == this_node_ || (!is_host() && !is_host(i)))
+				continue;
+
+			rma_peer& peer = peers[i];
+			char* region = mailbox + region_displacement(this_node_, i);
+			peer.local_buffers = region;
+			peer.local_flags = reinterpret_cast<cache_line_buffer*>(region + msg_buffers * msg_size);
+			peer.remote_displacement = region_displacement(i, this_node_);
+			reset_flags(peer.local_flags);
+
+			if (is_host())
+			{
+				peer.send_buffers = allocate_buffer<char>(msg_buffers * msg_size, this_node_).get();
+
+				// fill resource pools
+				for (size_t j = msg_buffers; j > 0; --j) {
+					peer.remote_buffer_pool.add(j-1);
+					peer.local_buffer_pool.add(j-1);
+				}
+
+				// allocate the first request to be used for the next send
+				allocate_next_request(i);
+			}
+		}
+
+		// data window for buffers from allocate_buffer(), NOTE: created after the staging buffers, which need no attaching
+		MPI_Win_create_dynamic(MPI_INFO_NULL, MPI_COMM_WORLD, &data_win);
+
+		// passive target synchronisation for the whole runtime
+		MPI_Win_lock_all(MPI_MODE_NOCHECK, mailbox_win);
+		MPI_Win_lock_all(MPI_MODE_NOCHECK, data_win);
+
+		MPI_Barrier(MPI_COMM_WORLD); // all flags must be initialised before the first message is sent
+
+		if (comm_options.print_footprint() && is_host())
+			HAM_LOG << "communicator: " << msg_buffers << " message buffers of " << msg_size << " B per peer and direction, host footprint per peer: " << (region_size() + msg_buffers * msg_size) << " B (mailbox + staging), target footprint: " << region_size() << " B" << std::endl;
+		HAM_DEBUG( HAM_LOG << "communicator::communicator(): initialising MPI done" << std::endl; )
+	}
+
+	~communicator()
+	{
+		MPI_Win_unlock_all(data_win);
+		MPI_Win_unlock_all(mailbox_win);
+		MPI_Win_free(&data_win);
+		MPI_Win_free(&mailbox_win); // NOTE: collective, also frees the mailbox memory
+
+		for (node_t i = 0; i < static_cast<node_t>(nodes_); ++i)
+			free(peers[i].send_buffers);
+		delete [] peers;
+
+		MPI_Finalize(); // TODO(improvement): check on error and create output if there was one
+		HAM_DEBUG( HAM_LOG << "~communicator" << std::endl; )
+	}
+
+private:
+	// pre-allocates the next request and modifies remote_node's internal peer data
+	const request& allocate_next_request(node_t remote_node)
+	{
+		HAM_DEBUG( HAM_LOG << "communicator::allocate_next_request(): remote_node = " << remote_node << std::endl; )
+
+		const size_t remote_buffer_index = peers[remote_node].remote_buffer_pool.allocate();
+		const size_t local_buffer_index = peers[remote_node].local_buffer_pool.allocate();
+
+		peers[remote_node].next_request = { remote_node, remote_buffer_index, this_node_, local_buffer_index };
+
+		return peers[remote_node].next_request;
+	}
+
+public:
+	request allocate_request(node_t remote_node)
+	{
+		// NOTE: each message carries the index of the next one, so concurrent senders to the same peer are serialised,
+		//       the lock is held from here until commit_msg() sends the message belonging to the returned request
+		peers[remote_node].send_mutex.lock();
+		// there is always one pre_allocated request, that corresponds to the next buffer index written to the receiver in the last send
+		return peers[remote_node].next_request;
+	}
+
+	// like allocate_request(), but returns an invalid request instead of over-allocating, if all buffers to remote_node are in use
+	request try_allocate_request(node_t remote_node)
+	{
+		rma_peer& peer = peers[remote_node];
+		peer.send_mutex.lock();
+		// NOTE: commit_msg() pre-allocates the next request, so it needs one free buffer on both sides
+		if (peer.remote_buffer_pool.empty() || peer.local_buffer_pool.empty()) {
+			peer.send_mutex.unlock();
+			return request();
+		}
+		return peer.next_request;
+	}
+
+	void free_request(request_reference_type req)
+	{
+		assert(req.source_node == this_node_);
+
+		rma_peer& peer = peers[req.target_node];
+
+		// reset the local flag, the remote flag was reset by the receiver (see recv_msg())
+		volatile size_t* local_flag = reinterpret_cast<size_t*>(&peer.local_flags[req.source_buffer_index]);
+		*local_flag = FLAG_FALSE;
+
+		// pool indices
+		peer.remote_buffer_pool.free(req.target_buffer_index);
+		peer.local_buffer_pool.free(req.source_buffer_index);
+
+		// invalidate request
+		req.target_buffer_index = NO_BUFFER_INDEX;
+	}
+
+	// two-phase send, 1st step: returns the local staging buffer belonging to req, in which the message can be constructed in place
+	void* reserve_msg_buffer(request_reference_type req)
+	{
+		return static_cast<void*>(peers[req.target_node].send_buffers + req.target_buffer_index * msg_size);
+	}
+
+	// two-phase send, 2nd step: puts the message of size byte inside reserve_msg_buffer(req) into the target's mailbox
+	void commit_msg(request_reference_type req, size_t size)
+	{
+		const request& next_req = allocate_next_request(req.target_node); // pre-allocate-request for the next send, because we set this index on the remote size
+
+		HAM_DEBUG( HAM_LOG << "communicator::commit_msg(): " <<
+			"request(" << req.target_node << ", " << req.target_buffer_index << ", " << req.source_node << ", " << req.source_buffer_index << ")" << std::endl );
+
+		send_msg(req.target_node, req.target_buffer_index, next_req.target_buffer_index, reserve_msg_buffer(req), size);
+
+		peers[req.target_node].send_mutex.unlock(); // locked in allocate_request()
+	}
+
+	void send_msg(request_reference_type req, void* msg, size_t size)
+	{
+		memcpy(reserve_msg_buffer(req), msg, size);
+		commit_msg(req, size);
+	}
+
+private:
+	void send_msg(node_t node, size_t buffer_index, size_t next_buffer_index, void* msg, size_t size)
+	{
+		HAM_DEBUG( HAM_LOG << "communicator::send_msg(): node = " << node << ", buffer index = " << buffer_index << ", size = " << size << std::endl; )
+
+		const MPI_Aint buffer_displacement = peers[node].remote_displacement + buffer_index * msg_size;
+		const MPI_Aint flag_displacement = peers[node].remote_displacement + msg_buffers * msg_size + buffer_index * sizeof(cache_line_buffer);
+
+		// write the message, it must be complete at the target before the flag is written
+		MPI_Put(msg, size, MPI_BYTE, node, buffer_displacement, size, MPI_BYTE, mailbox_win);
+		MPI_Win_flush(node, mailbox_win);
+
+		// signal the remote side that the message has been written, and transfer the next buffer/flag index in the process
+		// NOTE: accumulate is element-wise atomic, i.e. the flag is never observed half written
+		uint64_t flag = next_buffer_index;
+		MPI_Accumulate(&flag, 1, MPI_UINT64_T, node, flag_displacement, 1, MPI_UINT64_T, MPI_REPLACE, mailbox_win);
+		MPI_Win_flush(node, mailbox_win); // TODO(improvement): could be deferred to the next send, but flag is a local
+	}
+
+	void* recv_msg(node_t node, size_t buffer_index = NO_BUFFER_INDEX)
+	{
+		const bool use_next_flag = buffer_index == NO_BUFFER_INDEX;
+		// use next_flag as index, if none is given
+		buffer_index = use_next_flag ? peers[node].next_flag : buffer_index;
+		HAM_DEBUG( HAM_LOG << "communicator::recv_msg(): remote node is: " << node << ", using buffer index: " << buffer_index << std::endl; )
+
+		volatile size_t* local_flag = reinterpret_cast<size_t*>(&peers[node].local_flags[buffer_index]);
+
+		while (*local_flag == FLAG_FALSE) // poll on flag
+			MPI_Win_sync(mailbox_win); // synchronise public and private window copy, and trigger MPI progress
+
+		if (use_next_flag)
+		{
+			peers[node].next_flag = *local_flag; // the flag contains the next buffer index to poll on
+			*local_flag = FLAG_FALSE; // the sender can only re-use this buffer after we sent the result, so reset the flag here instead of remotely
+		}
+
+		return static_cast<void*>(peers[node].local_buffers + buffer_index * msg_size); // we directly return our buffer here, which is safe, since it can only be re-used after being freed by the future which returns the result by value to the user
+	}
+
+	bool test_local_flag(node_t node, size_t buffer_index)
+	{
+		MPI_Win_sync(mailbox_win);
+		volatile size_t* local_flag = reinterpret_cast<size_t*>(&peers[node].local_flags[buffer_index]);
+		return *local_flag != FLAG_FALSE; // set from the other side by send_result
+	}
+
+public:
+	// receive offload messages from the host
+	void* recv_msg_host(void* msg = nullptr, size_t size = 0)
+	{
+		HAM_UNUSED_VAR(msg);
+		HAM_UNUSED_VAR(size);
+		return recv_msg(host_node_);
+	}
+
+	// sends the result of a message back to its sender, called by the receiver of the message
+	void send_result(const reply_descriptor& reply, void* result_msg, size_t size)
+	{
+		assert(reply.valid());
+		send_msg(reply.source_node, reply.source_buffer_index, NO_BUFFER_INDEX, result_msg, size);
+	}
+
+	// trigger receiving the result of size byte on the sending side
+	void recv_result(request_reference_type req, size_t size)
+	{
+		HAM_UNUSED_VAR(req);
+		HAM_UNUSED_VAR(size);
+		// nothing todo here, since this communicator implementation uses one-sided communication
+		// the data is already where it is expected (in the buffer referenced in req)
+		return;
+	}
+
+	template<typename T>
+	void send_data(T* local_source, buffer_ptr<T>& remote_dest, size_t size)
+	{
+		HAM_DEBUG( HAM_LOG << "communicator::send_data(): writing " << size << " elements from " << local_source << " to " << remote_dest.get() << " on node " << remote_dest.node() << std::endl; )
+		MPI_Put((void*)local_source, size * sizeof(T), MPI_BYTE, remote_dest.node(), data_displacement(remote_dest.get()), size * sizeof(T), MPI_BYTE, data_win);
+		MPI_Win_flush(remote_dest.node(), data_win);
+	}
+
+	template<typename T>
+	void recv_data(buffer_ptr<T>& remote_source, T* local_dest, size_t size)
+	{
+		HAM_DEBUG( HAM_LOG << "communicator::recv_data(): reading " << size << " elements from " << remote_source.get() << " on node " << remote_source.node() << " to " << local_dest << std::endl; )
+		MPI_Get((void*)local_dest, size * sizeof(T), MPI_BYTE, remote_source.node(), data_displacement(remote_source.get()), size * sizeof(T), MPI_BYTE, data_win);
+		MPI_Win_flush(remote_source.node(), data_win);
+	}
+
+	template<typename T>
+	buffer_ptr<T> allocate_buffer(const size_t n, node_t source_node)
+	{
+		HAM_UNUSED_VAR(source_node); // NOTE: might be needed in other communicator implementations
+		T* ptr = nullptr;
+		int err =
+		posix_memalign((void**)&ptr, constants::CACHE_LINE_SIZE, n * sizeof(T));
+
+		if (err != 0) {
+			switch (err) {
+				case EINVAL:
+					HAM_LOG << "allocate_buffer(): The alignment argument was not a power of two, or was not a multiple of sizeof(void *)." << std::endl;
+					break;
+				case ENOMEM:
+					HAM_LOG << "allocate_buffer(): There was insufficient memory to fulfill the allocation request." << std::endl;
+					break;
+				default:
+					HAM_LOG << "allocate_buffer(): Unknown error." << std::endl;
+					break;
+			}
+		}
+
+		// make the buffer remotely accessible, NOTE: local operation
+		if (data_win != MPI_WIN_NULL)
+			MPI_Win_attach(data_win, ptr, n * sizeof(T));
+
+		// NOTE: no ctor is called
+		return buffer_ptr<T>(ptr, this_node_);
+	}
+
+	template<typename T>
+	void free_buffer(buffer_ptr<T> ptr)
+	{
+		assert(ptr.node() == this_node_);
+		MPI_Win_detach(data_win, ptr.get());
+		// NOTE: no dtor is called
+		free(static_cast<void*>(ptr.get()));
+	}
+
+	static communicator& instance() { return *instance_; }
+	static bool initialised() { return instance_ != nullptr; };
+	static node_t this_node() { return instance().this_node_; }
+	static size_t num_nodes() { return instance().nodes_; }
+	bool is_host() const { return this_node_ == host_node_; }
+	bool is_host(node_t node) const { return node == host_node_; }
+
+	static const node_descriptor& get_node_description(node_t node)
+	{
+		return instance().node_descriptions[node];
+	}
+
+	// size of the message buffers, see --ham-msg-size
+	static size_t max_msg_size() { return instance().msg_size; }
+
+	// number of message buffers per peer, see --ham-msg-buffers
+	static size_t num_msg_buffers() { return instance().msg_buffers; }
+
+private:
+	static_assert(sizeof(size_t) == sizeof(uint64_t), "flags are accumulated as MPI_UINT64_T");
+
+	// mailbox region: message buffers | flags
+	size_t region_size() const
+	{
+		return msg_buffers * (msg_size + sizeof(cache_line_buffer));
+	}
+
+	// offset of the region for messages from peer inside the mailbox window of owner
+	MPI_Aint region_displacement(node_t owner, node_t peer) const
+	{
+		// NOTE: relies on the host being rank 0, like host_node_
+		return is_host(owner) ? static_cast<MPI_Aint>((peer - 1) * region_size()) : 0;
+	}
+
+	// dynamic windows are addressed by absolute addresses of the target process
+	template<typename T>
+	static MPI_Aint data_displacement(T* remote_address)
+	{
+		return reinterpret_cast<MPI_Aint>(remote_address); // NOTE: MPI_Get_address() would need the remote process, this is equivalent on common platforms
+	}
+
+	void reset_flags(cache_line_buffer* flags)
+	{
+		for (size_t i = 0; i < msg_buffers; ++i)
+			*reinterpret_cast<size_t*>(&flags[i]) = FLAG_FALSE;
+	}
+
+	static communicator* instance_;
+	node_t this_node_;
+	size_t nodes_;
+	node_t host_node_;
+	std::vector<node_descriptor> node_descriptions;
+	size_t msg_size; // size of each message buffer
+	size_t msg_buffers; // number of message buffers per peer and direction
+
+	MPI_Win mailbox_win = MPI_WIN_NULL; // message buffers and flags, written by peers
+	MPI_Win data_win = MPI_WIN_NULL; // dynamic window, contains all buffers from allocate_buffer()
+
+	struct rma_peer {
+		request next_request; // the next request, belonging to next flag
+		std::mutex send_mutex; // held from allocate_request() until commit_msg()
+		size_t next_flag = 0; // flag
+
+		char* send_buffers = nullptr; // local staging buffers for messages to the peer, only used by the host
+		char* local_buffers = nullptr; // inside the mailbox window, the peer writes messages to this process into these buffers
+		cache_line_buffer* local_flags = nullptr; // inside the mailbox window, the peer signals writing is complete via these flags
+		MPI_Aint remote_displacement = 0; // offset of this process' region inside the peer's mailbox window
+
+		// needed by sender to manage which buffers are in use and which are free
+		detail::resource_pool<size_t> remote_buffer_pool;
+		detail::resource_pool<size_t> local_buffer_pool;
+	};
+
+	rma_peer* peers;
+};
+
+template<typename T>
+buffer_ptr<T>::buffer_ptr() : buffer_ptr(nullptr, communicator::this_node()) { }
+
+template<typename T>
+T& buffer_ptr<T>::operator[](size_t i)
+{
+	assert(node_ == communicator::this_node());
+	return ptr_[i];
+}
+
+} // namespace net
+} // namespace ham
+
+#endif // ham_net_communicator_mpi_rma_hpp
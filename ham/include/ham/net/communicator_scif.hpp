@@ -14,6 +14,7 @@
 
 #include <boost/program_options.hpp>
 #include <scif.h>
+#include <mutex>
 
 #include "ham/misc/constants.hpp"
 #include "ham/misc/options.hpp"
@@ -160,11 +161,10 @@ public:
 		}
 
 
-		template<class T>
-		void send_result(T* result_msg, size_t size)
+		// the compact part of this request, that is sent along with a message, see communicator::send_result()
+		reply_descriptor reply() const
 		{
-			assert(communicator::this_node() == target_node); // this assert fails if send_result is called from the wrong side
-			communicator::instance().send_msg(source_node, source_buffer_index, NO_BUFFER_INDEX, result_msg, size);
+			return { source_node, valid() ? static_cast<uint32_t>(source_buffer_index) : static_cast<uint32_t>(reply_descriptor::NO_REPLY) };
 		}
 
 		bool valid() const
@@ -192,6 +192,9 @@ public:
 
 		HAM_DEBUG( HAM_LOG << "FLAG_FALSE = " << FLAG_FALSE << ", NO_BUFFER_INDEX = " << NO_BUFFER_INDEX << std::endl; )
 
+		if (!comm_options.default_msg_config())
+			HAM_LOG << "communicator::communicator(): warning: --ham-msg-size and --ham-msg-buffers are not supported by this backend, using " << constants::MSG_BUFFERS << " buffers of " << constants::MSG_SIZE << " B" << std::endl;
+
 		// SCIF setup
 
 		// allocate peer data structures
@@ -399,6 +402,9 @@ private:
 public:
 	request allocate_request(node_t remote_node)
 	{
+		// NOTE: each message carries the index of the next one, so concurrent senders to the same peer are serialised,
+		//       the lock is held from here until commit_msg() sends the message belonging to the returned request
+		peers[remote_node].send_mutex.lock();
 		{
 			HAM_DEBUG(
 			HAM_LOG << "communicator::allocate_request(): remote_node = " << remote_node << std::endl;
@@ -410,6 +416,19 @@ public:
 		return peers[remote_node].next_request;
 	}
 
+	// like allocate_request(), but returns an invalid request instead of over-allocating, if all buffers to remote_node are in use
+	request try_allocate_request(node_t remote_node)
+	{
+		scif_peer& peer = peers[remote_node];
+		peer.send_mutex.lock();
+		// NOTE: commit_msg() pre-allocates the next request, so it needs one free buffer on both sides
+		if (peer.remote_buffer_pool.empty() || peer.local_buffer_pool.empty()) {
+			peer.send_mutex.unlock();
+			return request();
+		}
+		return peer.next_request;
+	}
+
 	void free_request(request_reference_type req)
 	{
 		assert(req.source_node == ham_address);
@@ -431,32 +450,56 @@ public:
 		req.target_buffer_index = NO_BUFFER_INDEX;
 	}
 
-	void send_msg(request_reference_type req, void* msg, size_t size)
+	// two-phase send, 1st step: returns the mapped remote buffer belonging to req, in which the message can be constructed in place
+	void* reserve_msg_buffer(request_reference_type req)
+	{
+		return msg_payload(req.target_node, req.target_buffer_index);
+	}
+
+	// two-phase send, 2nd step: signals the target that the message of size byte inside reserve_msg_buffer(req) is complete
+	void commit_msg(request_reference_type req, size_t size)
 	{
 		const request& next_req = allocate_next_request(req.target_node); // pre-allocate-request for the next send, because we set this index on the remote size
 
-		HAM_DEBUG( HAM_LOG << "communicator::send_msg(): " <<
+		HAM_DEBUG( HAM_LOG << "communicator::commit_msg(): " <<
 			"request(" << req.target_node << ", " << req.target_buffer_index << ", " << req.source_node << ", " << req.source_buffer_index << ")" << std::endl );
 
-		send_msg(req.target_node, req.target_buffer_index, next_req.target_buffer_index, msg, size);
-		//send_msg(req.target_node, req.target_buffer_index, peers[req.target_node].remote_buffer_pool.next(), msg, size);
+		commit_msg(req.target_node, req.target_buffer_index, next_req.target_buffer_index, size);
+
+		peers[req.target_node].send_mutex.unlock(); // locked in allocate_request()
+	}
+
+	void send_msg(request_reference_type req, void* msg, size_t size)
+	{
+		memcpy(reserve_msg_buffer(req), msg, size);
+		commit_msg(req, size);
 	}
 
 private:
+	// the message is located behind the size header inside the mapped remote buffer
+	void* msg_payload(node_t node, size_t buffer_index)
+	{
+		return reinterpret_cast<char*>(&peers[node].mapped_remote_buffers[buffer_index]) + sizeof(size_t);
+	}
+
 	void send_msg(node_t node, size_t buffer_index, size_t next_buffer_index, void* msg, size_t size)
 	{
-		HAM_DEBUG( HAM_LOG << "communicator::send_msg(): node =  " << node << std::endl; )
-		HAM_DEBUG( HAM_LOG << "communicator::send_msg(): remote buffer index = " << buffer_index << std::endl; )
+		memcpy(msg_payload(node, buffer_index), msg, size);
+		commit_msg(node, buffer_index, next_buffer_index, size);
+	}
+
+	void commit_msg(node_t node, size_t buffer_index, size_t next_buffer_index, size_t size)
+	{
+		HAM_DEBUG( HAM_LOG << "communicator::commit_msg(): node =  " << node << std::endl; )
+		HAM_DEBUG( HAM_LOG << "communicator::commit_msg(): remote buffer index = " << buffer_index << std::endl; )
 
 		char* mapped_remote_buffer = reinterpret_cast<char*>(&peers[node].mapped_remote_buffers[buffer_index]);
 		volatile size_t* mapped_remote_flag = reinterpret_cast<size_t*>(&peers[node].mapped_remote_flags[buffer_index]);
-		HAM_DEBUG( HAM_LOG << "communicator::send_msg(): mapped remote buffer is: " << (void*)mapped_remote_buffer << std::endl; )
+		HAM_DEBUG( HAM_LOG << "communicator::commit_msg(): mapped remote buffer is: " << (void*)mapped_remote_buffer << std::endl; )
 
-		HAM_DEBUG( HAM_LOG << "communicator::send_msg(): sending message of size: " << size << std::endl; )
-		// copy to remote memory
+		HAM_DEBUG( HAM_LOG << "communicator::commit_msg(): sending message of size: " << size << std::endl; )
+		// the message is already in remote memory, add the size header
 		memcpy((char*)mapped_remote_buffer, (void*)&size, sizeof(size_t)); // size = header
-
-		memcpy((char*)mapped_remote_buffer + sizeof(size_t), msg , size);
 		_mm_sfence(); // NOTE: intel intrinsic: store fence, make changes visible on the remote site to which we wrote
 
 		*mapped_remote_flag = next_buffer_index; // signal remote side that the message has been written, and transfer the next buffer/flag index in the process
@@ -505,9 +548,18 @@ public:
 		return recv_msg(ham_host_address, NO_BUFFER_INDEX, msg, size);
 	}
 	
-	// trigger receiving the result of a message on the sending side
-	void recv_result(request_reference_type req)
+	// sends the result of a message back to its sender, called by the receiver of the message
+	void send_result(const reply_descriptor& reply, void* result_msg, size_t size)
+	{
+		assert(reply.valid());
+		send_msg(reply.source_node, reply.source_buffer_index, NO_BUFFER_INDEX, result_msg, size);
+	}
+
+	// trigger receiving the result of size byte on the sending side
+	void recv_result(request_reference_type req, size_t size)
 	{
+		HAM_UNUSED_VAR(req);
+		HAM_UNUSED_VAR(size);
 		// nothing todo here, since this communicator implementation uses one-sided communication
 		// the data is already where it is expected (in the buffer referenced in req)
 		return;
@@ -583,6 +635,8 @@ public:
 	static bool initialised() { return instance_ != nullptr; };
 	static node_t this_node() { return instance().ham_address; }
 	static size_t num_nodes() { return instance().ham_process_count; }
+	static size_t max_msg_size() { return constants::MSG_SIZE; } // NOTE: fixed, see constants.hpp
+	static size_t num_msg_buffers() { return constants::MSG_BUFFERS; } // NOTE: fixed, see constants.hpp
 	bool is_host() const { return ham_address == ham_host_address ; }
 	bool is_host(node_t node) const { return node == ham_host_address; }
 
@@ -626,6 +680,7 @@ private:
 		{}
 
 		request next_request; // the next request, belonging to next flag
+		std::mutex send_mutex; // held from allocate_request() until commit_msg()
 
 		scif_epd_t endpoint; // endpoint to the connection with this peer
 
@@ -0,0 +1,714 @@
+// Copyright (c) 2013-2019 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ham_net_communicator_shm_hpp
+#define ham_net_communicator_shm_hpp
+
+#include <mutex>
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <errno.h>
+#include <fcntl.h> // O_* constants
+#include <signal.h> // kill
+#include <stdlib.h> // posix_memalign
+#include <string.h> // errno messages
+#include <string>
+#include <sys/mman.h> // shm_open, mmap
+#include <sys/prctl.h> // prctl
+#include <sys/stat.h>
+#include <sys/uio.h> // process_vm_readv, process_vm_writev
+#include <unistd.h>
+
+#include "ham/misc/constants.hpp"
+#include "ham/misc/options.hpp"
+#include "ham/misc/resource_pool.hpp"
+#include "ham/misc/types.hpp"
+#include "ham/util/debug.hpp"
+#include "ham/util/log.hpp"
+
+namespace ham {
+namespace net {
+
+template<typename T>
+class buffer_ptr
+{
+public:
+	buffer_ptr();
+	buffer_ptr(T* ptr, node_t node) : ptr_(ptr), node_(node) { }
+
+	T* get() const { return ptr_; }
+	node_t node() const { return node_; }
+
+	// element access
+	T& operator[](size_t i);
+
+	// basic pointer arithmetic to address sub-buffers
+	buffer_ptr<T> operator+(size_t off)
+	{
+		return buffer_ptr(ptr_ + off, node_);
+	}
+
+private:
+	T* ptr_; // address inside the address space of node_
+	node_t node_;
+};
+
+class node_descriptor
+{
+public:
+	const char* name() const { return name_; }
+
+private:
+	static constexpr size_t name_length_ {256};
+	char name_[name_length_];
+
+	friend class communicator;
+};
+
+class communicator_options : public ham::detail::options
+{
+public:
+	communicator_options(int* argc_ptr, char** argv_ptr[]) : options(argc_ptr, argv_ptr)
+	{
+		// add backend-specific options
+		app_.add_option("--ham-process-count", ham_process_count_, "Number of processes the job consists of (number of targets + 1).");
+		app_.add_option("--ham-address", ham_address_, "This processes address, between 0 and host-process-count minus 1.");
+		app_.add_option("--ham-host-address", ham_host_address_, "The address of the host process (0 by default).");
+		app_.add_option("--ham-shm-name", shm_name_, "Name prefix of the shared memory segments, must be unique for concurrently running jobs.");
+
+		// NOTE: no further inheritance or adding
+		parse();
+	}
+
+	// command line argument getters
+	const node_t& ham_process_count() const { return ham_process_count_; }
+	const node_t& ham_address() const { return ham_address_; }
+	const node_t& ham_host_address() const { return ham_host_address_; }
+	const std::string& shm_name() const { return shm_name_; }
+
+private:
+	node_t ham_process_count_ = 2; // number of participating processes
+	node_t ham_address_ = 0; // this processes' address
+	node_t ham_host_address_ = 0; // the address of the host process
+	std::string shm_name_ = "ham_" + std::to_string(getuid());
+};
+
+// NOTE: this communicator implements the one-sided flag protocol of the SCIF communicator
+//       on top of POSIX shared memory, i.e. for processes inside the same shared memory domain
+//       there is one segment per host-target pair containing the message buffers and flags of both directions
+//       data transfers are one-sided via process_vm_writev/process_vm_readv into the target's address space
+class communicator {
+public:
+	// NOTE: the number of buffers is only known at runtime, so the special values are taken from the top of the index range
+	enum : size_t {
+		NO_BUFFER_INDEX = SIZE_MAX - 1, // invalid buffer index
+		FLAG_FALSE = SIZE_MAX, // special value, outside normal index range
+		SEGMENT_READY = 0x4841 // special value, signals that a segment was initialised by the host or attached by the target
+	};
+
+	// externally used interface of request must be shared across all communicator-implementations
+	struct request {
+
+		request() : target_buffer_index(NO_BUFFER_INDEX) {} // instantiate invalid
+		request(node_t target_node, size_t target_buffer_index, node_t source_node, size_t source_buffer_index)
+		 : target_node(target_node), target_buffer_index(target_buffer_index), source_node(source_node), source_buffer_index(source_buffer_index)
+		{}
+
+		bool test() const
+		{
+			return communicator::instance().test_local_flag(target_node, source_buffer_index);
+		}
+
+		void* get() const // blocks
+		{
+			return communicator::instance().recv_msg(target_node, source_buffer_index); // we wait for the remote side, to write into our buffer/flag
+		}
+
+		// the compact part of this request, that is sent along with a message, see communicator::send_result()
+		reply_descriptor reply() const
+		{
+			return { source_node, valid() ? static_cast<uint32_t>(source_buffer_index) : static_cast<uint32_t>(reply_descriptor::NO_REPLY) };
+		}
+
+		bool valid() const
+		{
+			return target_buffer_index != NO_BUFFER_INDEX;
+		}
+
+		node_t target_node;
+		size_t target_buffer_index; // for sending to target node
+		node_t source_node;
+		size_t source_buffer_index; // for receiving from target node
+	};
+
+	typedef request& request_reference_type;
+	typedef const request& request_const_reference_type;
+
+	communicator(communicator_options& comm_options)
+	 : ham_process_count(comm_options.ham_process_count()),
+	   ham_address(comm_options.ham_address()),
+	   ham_host_address(comm_options.ham_host_address()),
+	   shm_name(comm_options.shm_name()),
+	   msg_size(comm_options.msg_size()),
+	   msg_buffers(comm_options.msg_buffers())
+	{
+		instance_ = this;
+
+		HAM_DEBUG( HAM_LOG << "FLAG_FALSE = " << FLAG_FALSE << ", NO_BUFFER_INDEX = " << NO_BUFFER_INDEX << std::endl; )
+
+		// allocate peer data structures
+		peers = new shm_peer[ham_process_count];
+
+		// get own hostname
+		errno_handler(gethostname(peers[ham_address].node_description.name_, node_descriptor::name_length_), "gethostname");
+
+		// allow the host to access this process' memory via process_vm_readv/writev,
+		// this is needed if ptrace is restricted to descendants (e.g. Yama), the call fails harmlessly otherwise
+		prctl(PR_SET_PTRACER, PR_SET_PTRACER_ANY, 0, 0, 0);
+
+		if (is_host())
+		{
+			// create and initialise one segment per offload target
+			for (node_t i = 0; i < ham_process_count; ++i)
+			{
+				if (i == ham_host_address)
+					continue;
+
+				shm_peer& peer = peers[i];
+				const std::string name = segment_name(i);
+
+				shm_unlink(name.c_str()); // remove a stale segment of an aborted run, if there is one
+				int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+				errno_handler(fd, "shm_open");
+				errno_handler(ftruncate(fd, segment_size()), "ftruncate");
+				map_segment(peer, fd);
+
+				reset_flags(peer.local_flags);
+				reset_flags(peer.remote_flags);
+
+				peer.header->msg_size = msg_size;
+				peer.header->msg_buffers = msg_buffers;
+				peer.header->host_pid = getpid();
+				peer.header->host_description = peers[ham_address].node_description;
+
+				// fill resource pools
+				for (size_t j = msg_buffers; j > 0; --j) {
+					peer.remote_buffer_pool.add(j-1);
+					peer.local_buffer_pool.add(j-1);
+				}
+
+				// allocate the first request to be used for the next send
+				allocate_next_request(i);
+
+				std::atomic_thread_fence(std::memory_order_release); // make the initialisation visible before signalling
+				peer.header->host_ready = SEGMENT_READY;
+			}
+
+			// wait for all offload targets to attach
+			for (node_t i = 0; i < ham_process_count; ++i)
+			{
+				if (i == ham_host_address)
+					continue;
+
+				shm_peer& peer = peers[i];
+				HAM_DEBUG( HAM_LOG << "communicator::communicator(): waiting for target " << i << " to attach" << std::endl; )
+				while (peer.header->target_ready != SEGMENT_READY)
+					usleep(SETUP_POLL_INTERVAL);
+				std::atomic_thread_fence(std::memory_order_acquire);
+
+				peer.pid = peer.header->target_pid;
+				peer.node_description = peer.header->target_description;
+
+				// both sides are attached, the segment persists until it is unmapped by both
+				shm_unlink(segment_name(i).c_str());
+				HAM_DEBUG( HAM_LOG << "communicator::communicator(): target " << i << " attached, pid = " << peer.pid << std::endl; )
+			}
+
+			// tell the targets each other's process ids, which they need for data transfers between them (e.g. offload::copy_async())
+			for (node_t i = 0; i < ham_process_count; ++i)
+			{
+				if (i == ham_host_address)
+					continue;
+
+				pid_t* pids = peer_pids(peers[i]);
+				for (node_t j = 0; j < ham_process_count; ++j)
+					pids[j] = (j == ham_host_address) ? getpid() : peers[j].pid;
+				std::atomic_thread_fence(std::memory_order_release);
+				peers[i].header->peers_ready = SEGMENT_READY;
+			}
+
+			if (comm_options.print_footprint())
+				HAM_LOG << "communicator: " << msg_buffers << " message buffers of " << msg_size << " B per peer and direction, shared memory footprint per peer: " << segment_size() << " B" << std::endl;
+		}
+		else // offload target
+		{
+			shm_peer& host_peer = peers[ham_host_address];
+			const std::string name = segment_name(ham_address);
+
+			while (true)
+			{
+				// wait for the host to create the segment
+				int fd = shm_open(name.c_str(), O_RDWR, 0);
+				if (fd < 0) {
+					if (errno != ENOENT)
+						errno_handler(fd, "shm_open");
+					usleep(SETUP_POLL_INTERVAL);
+					continue;
+				}
+
+				// wait for the host to size the segment
+				struct stat segment_stat;
+				errno_handler(fstat(fd, &segment_stat), "fstat");
+				if (static_cast<size_t>(segment_stat.st_size) <= header_size()) {
+					close(fd);
+					usleep(SETUP_POLL_INTERVAL);
+					continue;
+				}
+
+				// NOTE: the buffer configuration of the host is only known after the header is initialised
+				map_segment(host_peer, fd, segment_stat.st_size);
+
+				// wait for the host to initialise the segment
+				while (host_peer.header->host_ready != SEGMENT_READY)
+					usleep(SETUP_POLL_INTERVAL);
+				std::atomic_thread_fence(std::memory_order_acquire);
+
+				if (kill(host_peer.header->host_pid, 0) == 0) { // the host is alive
+					// use the host's buffer configuration
+					msg_size = host_peer.header->msg_size;
+					msg_buffers = host_peer.header->msg_buffers;
+					assert(host_peer.mapped_size == segment_size());
+					set_segment_pointers(host_peer);
+					break;
+				}
+
+				// NOTE: we got a stale segment of an aborted run, the host will replace it
+				HAM_DEBUG( HAM_LOG << "communicator::communicator(): detected stale segment: " << name << std::endl; )
+				unmap_segment(host_peer);
+				usleep(SETUP_POLL_INTERVAL);
+			}
+
+			host_peer.pid = host_peer.header->host_pid;
+			host_peer.node_description = host_peer.header->host_description;
+
+			host_peer.header->target_pid = getpid();
+			host_peer.header->target_description = peers[ham_address].node_description;
+			std::atomic_thread_fence(std::memory_order_release);
+			host_peer.header->target_ready = SEGMENT_READY;
+
+			// wait for the process ids of the other targets, i.e. until all targets attached
+			while (host_peer.header->peers_ready != SEGMENT_READY)
+				usleep(SETUP_POLL_INTERVAL);
+			std::atomic_thread_fence(std::memory_order_acquire);
+
+			const pid_t* pids = peer_pids(host_peer);
+			for (node_t j = 0; j < ham_process_count; ++j)
+			{
+				if (j != ham_host_address && j != ham_address)
+					peers[j].pid = pids[j];
+			}
+		}
+	}
+
+	~communicator()
+	{
+		HAM_DEBUG( HAM_LOG << "~communicator" << std::endl; )
+
+		for (node_t i = 0; i < ham_process_count; ++i)
+		{
+			if (peers[i].header != nullptr)
+				unmap_segment(peers[i]);
+		}
+
+		delete [] peers;
+	}
+
+private:
+	// pre-allocates the next request and modifies remote_node's internal peer data
+	const request& allocate_next_request(node_t remote_node)
+	{
+		HAM_DEBUG( HAM_LOG << "communicator::allocate_next_request(): remote_node = " << remote_node << std::endl; )
+
+		const size_t remote_buffer_index = peers[remote_node].remote_buffer_pool.allocate();
+		const size_t local_buffer_index = peers[remote_node].local_buffer_pool.allocate();
+
+		peers[remote_node].next_request = { remote_node, remote_buffer_index, ham_address, local_buffer_index };
+
+		{
+			HAM_DEBUG(
+			request& req = peers[remote_node].next_request;
+			HAM_LOG << "communicator::allocate_next_request(): new next_request = " <<
+				"request(" << req.target_node << ", " << req.target_buffer_index << ", " << req.source_node << ", " << req.source_buffer_index << ")" << std::endl );
+		}
+
+		return peers[remote_node].next_request;
+	}
+
+public:
+	request allocate_request(node_t remote_node)
+	{
+		// NOTE: each message carries the index of the next one, so concurrent senders to the same peer are serialised,
+		//       the lock is held from here until commit_msg() sends the message belonging to the returned request
+		peers[remote_node].send_mutex.lock();
+		// there is always one pre_allocated request, that corresponds to the next buffer index written to the receiver in the last send
+		return peers[remote_node].next_request;
+	}
+
+	// like allocate_request(), but returns an invalid request instead of over-allocating, if all buffers to remote_node are in use
+	request try_allocate_request(node_t remote_node)
+	{
+		shm_peer& peer = peers[remote_node];
+		peer.send_mutex.lock();
+		// NOTE: commit_msg() pre-allocates the next request, so it needs one free buffer on both sides
+		if (peer.remote_buffer_pool.empty() || peer.local_buffer_pool.empty()) {
+			peer.send_mutex.unlock();
+			return request();
+		}
+		return peer.next_request;
+	}
+
+	void free_request(request_reference_type req)
+	{
+		assert(req.source_node == ham_address);
+
+		shm_peer& peer = peers[req.target_node];
+
+		// reset flags
+		volatile size_t* local_flag = reinterpret_cast<size_t*>(&peer.local_flags[req.source_buffer_index]);
+		volatile size_t* remote_flag = reinterpret_cast<size_t*>(&peer.remote_flags[req.target_buffer_index]);
+		*local_flag = FLAG_FALSE;
+		*remote_flag = FLAG_FALSE;
+
+		// pool indices
+		peer.remote_buffer_pool.free(req.target_buffer_index);
+		peer.local_buffer_pool.free(req.source_buffer_index);
+
+		// invalidate request
+		req.target_buffer_index = NO_BUFFER_INDEX;
+	}
+
+	// two-phase send, 1st step: returns the shared buffer belonging to req, in which the message can be constructed in place
+	void* reserve_msg_buffer(request_reference_type req)
+	{
+		return msg_payload(req.target_node, req.target_buffer_index);
+	}
+
+	// two-phase send, 2nd step: signals the target that the message of size byte inside reserve_msg_buffer(req) is complete
+	void commit_msg(request_reference_type req, size_t size)
+	{
+		const request& next_req = allocate_next_request(req.target_node); // pre-allocate-request for the next send, because we set this index on the remote size
+
+		HAM_DEBUG( HAM_LOG << "communicator::commit_msg(): " <<
+			"request(" << req.target_node << ", " << req.target_buffer_index << ", " << req.source_node << ", " << req.source_buffer_index << ")" << std::endl );
+
+		commit_msg(req.target_node, req.target_buffer_index, next_req.target_buffer_index, size);
+
+		peers[req.target_node].send_mutex.unlock(); // locked in allocate_request()
+	}
+
+	void send_msg(request_reference_type req, void* msg, size_t size)
+	{
+		memcpy(reserve_msg_buffer(req), msg, size);
+		commit_msg(req, size);
+	}
+
+private:
+	// the message is located behind the size header inside the shared buffer
+	void* msg_payload(node_t node, size_t buffer_index)
+	{
+		return peers[node].remote_buffers + buffer_index * msg_size + MSG_HEADER_SIZE;
+	}
+
+	void send_msg(node_t node, size_t buffer_index, size_t next_buffer_index, void* msg, size_t size)
+	{
+		memcpy(msg_payload(node, buffer_index), msg, size);
+		commit_msg(node, buffer_index, next_buffer_index, size);
+	}
+
+	void commit_msg(node_t node, size_t buffer_index, size_t next_buffer_index, size_t size)
+	{
+		HAM_DEBUG( HAM_LOG << "communicator::commit_msg(): node = " << node << ", buffer index = " << buffer_index << ", size = " << size << std::endl; )
+
+		char* remote_buffer = peers[node].remote_buffers + buffer_index * msg_size;
+		volatile size_t* remote_flag = reinterpret_cast<size_t*>(&peers[node].remote_flags[buffer_index]);
+
+		// the message is already in shared memory, add the size header
+		memcpy(remote_buffer, (void*)&size, sizeof(size_t)); // size = header
+		std::atomic_thread_fence(std::memory_order_release); // message and header must be visible before the flag
+
+		*remote_flag = next_buffer_index; // signal remote side that the message has been written, and transfer the next buffer/flag index in the process
+	}
+
+	void* recv_msg(node_t node, size_t buffer_index = NO_BUFFER_INDEX, void* msg = nullptr, size_t size = 0)
+	{
+		HAM_UNUSED_VAR(msg);
+		HAM_UNUSED_VAR(size);
+		// use next_flag as index, if none is given
+		buffer_index = buffer_index == NO_BUFFER_INDEX ?  peers[node].next_flag : buffer_index;
+		HAM_DEBUG( HAM_LOG << "communicator::recv_msg(): remote node is: " << node << ", using buffer index: " << buffer_index << std::endl; )
+
+		char* local_buffer = peers[node].local_buffers + buffer_index * msg_size;
+		volatile size_t* local_flag = reinterpret_cast<size_t*>(&peers[node].local_flags[buffer_index]);
+
+		while (*local_flag == FLAG_FALSE); // poll on flag
+		std::atomic_thread_fence(std::memory_order_acquire); // the message is visible after the flag
+
+		if (*local_flag != NO_BUFFER_INDEX) // the flag contains the next buffer index to poll on
+			peers[node].next_flag = *local_flag;
+
+		return local_buffer + MSG_HEADER_SIZE; // we directly return our buffer here, which is safe, since it can only be re-used after being freed by the future which returns the result by value to the user
+	}
+
+	bool test_local_flag(node_t node, size_t buffer_index)
+	{
+		volatile size_t* local_flag = reinterpret_cast<size_t*>(&peers[node].local_flags[buffer_index]);
+		return *local_flag != FLAG_FALSE; // set from the other side by send_result
+	}
+
+public:
+	// receive offload messages from the host
+	void* recv_msg_host(void* msg = nullptr, size_t size = 0)
+	{
+		return recv_msg(ham_host_address, NO_BUFFER_INDEX, msg, size);
+	}
+
+	// sends the result of a message back to its sender, called by the receiver of the message
+	void send_result(const reply_descriptor& reply, void* result_msg, size_t size)
+	{
+		assert(reply.valid());
+		send_msg(reply.source_node, reply.source_buffer_index, NO_BUFFER_INDEX, result_msg, size);
+	}
+
+	// trigger receiving the result of size byte on the sending side
+	void recv_result(request_reference_type req, size_t size)
+	{
+		HAM_UNUSED_VAR(req);
+		HAM_UNUSED_VAR(size);
+		// nothing todo here, since this communicator implementation uses one-sided communication
+		// the data is already where it is expected (in the buffer referenced in req)
+		return;
+	}
+
+	template<typename T>
+	void send_data(T* local_source, buffer_ptr<T>& remote_dest, size_t size)
+	{
+		HAM_DEBUG( HAM_LOG << "communicator::send_data(): writing " << size << " elements from " << local_source << " to " << remote_dest.get() << " on node " << remote_dest.node() << std::endl; )
+		struct iovec local = { (void*)local_source, size * sizeof(T) };
+		struct iovec remote = { (void*)remote_dest.get(), size * sizeof(T) };
+		ssize_t err = process_vm_writev(peers[remote_dest.node()].pid, &local, 1, &remote, 1, 0);
+		errno_handler(err, "process_vm_writev");
+		assert(static_cast<size_t>(err) == size * sizeof(T)); // NOTE: single iovec, no partial transfers
+	}
+
+	template<typename T>
+	void recv_data(buffer_ptr<T>& remote_source, T* local_dest, size_t size)
+	{
+		HAM_DEBUG( HAM_LOG << "communicator::recv_data(): reading " << size << " elements from " << remote_source.get() << " on node " << remote_source.node() << " to " << local_dest << std::endl; )
+		struct iovec local = { (void*)local_dest, size * sizeof(T) };
+		struct iovec remote = { (void*)remote_source.get(), size * sizeof(T) };
+		ssize_t err = process_vm_readv(peers[remote_source.node()].pid, &local, 1, &remote, 1, 0);
+		errno_handler(err, "process_vm_readv");
+		assert(static_cast<size_t>(err) == size * sizeof(T)); // NOTE: single iovec, no partial transfers
+	}
+
+	template<typename T>
+	buffer_ptr<T> allocate_buffer(const size_t n, node_t source_node)
+	{
+		HAM_UNUSED_VAR(source_node);
+		// NOTE: no ctor calls (buffer vs. array)
+		T* ptr = nullptr;
+		int err = posix_memalign((void**)&ptr, constants::CACHE_LINE_SIZE, n * sizeof(T));
+		HAM_UNUSED_VAR(err);
+		assert(err == 0);
+		return buffer_ptr<T>(ptr, ham_address);
+	}
+
+	template<typename T>
+	void free_buffer(buffer_ptr<T> ptr)
+	{
+		assert(ptr.node() == ham_address);
+		// NOTE: no ctor calls (buffer vs. array)
+		free((void*)ptr.get());
+	}
+
+	static const node_descriptor& get_node_description(node_t node)
+	{
+		return instance().peers[node].node_description;
+	}
+
+	// the payload size of the message buffers, see --ham-msg-size
+	static size_t max_msg_size() { return instance().msg_size - MSG_HEADER_SIZE; }
+
+	// number of message buffers per peer, see --ham-msg-buffers
+	static size_t num_msg_buffers() { return instance().msg_buffers; }
+
+	static communicator& instance() { return *instance_; }
+	static bool initialised() { return instance_ != nullptr; };
+	static node_t this_node() { return instance().ham_address; }
+	static size_t num_nodes() { return instance().ham_process_count; }
+	bool is_host() const { return ham_address == ham_host_address; }
+	bool is_host(node_t node) const { return node == ham_host_address; }
+
+private:
+	static constexpr useconds_t SETUP_POLL_INTERVAL = 1000; // µs
+	// NOTE: the size header is padded, so that payloads placed behind it keep the alignment of any type (e.g. long double)
+	static constexpr size_t MSG_HEADER_SIZE = alignof(std::max_align_t);
+	static_assert(MSG_HEADER_SIZE <= constants::CACHE_LINE_SIZE, "--ham-msg-size reserves a cache line for the header, see communicator_options::msg_size()");
+
+	// header at the beginning of each segment, used for connection setup, followed by the process ids of all processes (see peer_pids())
+	struct segment_header {
+		volatile size_t host_ready;
+		volatile size_t target_ready;
+		volatile size_t peers_ready; // the process ids behind the header are set
+		size_t msg_size; // buffer configuration of the host, adopted by the target
+		size_t msg_buffers;
+		pid_t host_pid;
+		pid_t target_pid;
+		node_descriptor host_description;
+		node_descriptor target_description;
+	};
+
+	// per-peer data, seen from this process
+	struct shm_peer {
+		request next_request; // the next request, belonging to next flag
+		std::mutex send_mutex; // held from allocate_request() until commit_msg()
+		size_t next_flag = 0; // flag
+
+		segment_header* header = nullptr; // beginning of the mapped segment
+		size_t mapped_size = 0;
+		pid_t pid = 0; // process id of the peer, used for data transfers, targets only know each other's after setup
+
+		char* local_buffers = nullptr; // the peer writes messages to this process into these msg_buffers buffers of msg_size
+		cache_line_buffer* local_flags = nullptr; // the peer signals writing is complete via these flags, I poll on these flags
+
+		char* remote_buffers = nullptr; // I write messages to the peer into these msg_buffers buffers of msg_size
+		cache_line_buffer* remote_flags = nullptr; // I write these flags to signal a message was sent
+
+		// needed by sender to manage which buffers are in use and which are free
+		// just manages indices, that can be used by
+		// the sender to go into remote_buffers/flags
+		// the receiver to go into local_buffers/flags
+		detail::resource_pool<size_t> remote_buffer_pool;
+		detail::resource_pool<size_t> local_buffer_pool;
+
+		node_descriptor node_description;
+	};
+
+	// segment layout: header | process ids | host -> target buffers | host -> target flags | target -> host buffers | target -> host flags
+	size_t header_size() const
+	{
+		return (sizeof(segment_header) + ham_process_count * sizeof(pid_t) + constants::PAGE_SIZE - 1) / constants::PAGE_SIZE * constants::PAGE_SIZE;
+	}
+
+	// the process ids of all processes, indexed by node, set by the host once all targets are attached
+	static pid_t* peer_pids(const shm_peer& peer)
+	{
+		return reinterpret_cast<pid_t*>(reinterpret_cast<char*>(peer.header) + sizeof(segment_header));
+	}
+
+	size_t direction_size() const
+	{
+		return msg_buffers * (msg_size + sizeof(cache_line_buffer));
+	}
+
+	size_t segment_size() const
+	{
+		return header_size() + 2 * direction_size();
+	}
+
+	std::string segment_name(node_t target) const
+	{
+		return "/" + shm_name + "_" + std::to_string(target);
+	}
+
+	void map_segment(shm_peer& peer, int fd)
+	{
+		map_segment(peer, fd, segment_size());
+		set_segment_pointers(peer);
+	}
+
+	void map_segment(shm_peer& peer, int fd, size_t size)
+	{
+		void* addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		errno_handler(addr == MAP_FAILED ? -1 : 0, "mmap");
+		close(fd); // the mapping stays valid
+
+		peer.header = static_cast<segment_header*>(addr);
+		peer.mapped_size = size;
+	}
+
+	// NOTE: requires msg_size and msg_buffers to match the segment
+	void set_segment_pointers(shm_peer& peer)
+	{
+		char* to_target = reinterpret_cast<char*>(peer.header) + header_size();
+		char* to_host = to_target + direction_size();
+		char* send_side = is_host() ? to_target : to_host;
+		char* recv_side = is_host() ? to_host : to_target;
+
+		peer.remote_buffers = send_side;
+		peer.remote_flags = reinterpret_cast<cache_line_buffer*>(send_side + msg_buffers * msg_size);
+		peer.local_buffers = recv_side;
+		peer.local_flags = reinterpret_cast<cache_line_buffer*>(recv_side + msg_buffers * msg_size);
+	}
+
+	void unmap_segment(shm_peer& peer)
+	{
+		errno_handler(munmap(static_cast<void*>(peer.header), peer.mapped_size), "munmap");
+		peer.header = nullptr;
+	}
+
+	void errno_handler(int ret, const char * hint)
+	{
+		if (ret < 0)
+		{
+			char buffer[ 256 ];
+			char * errorMessage = strerror_r( errno, buffer, 256 );
+			HAM_LOG << "Errno(" << errno << ") Message for \"" << hint << "\": " << errorMessage << std::endl;
+			exit(-1);
+		}
+	}
+
+	void reset_flags(cache_line_buffer* flags)
+	{
+		cache_line_buffer fill_value;
+		cache_line_buffer* fill_value_ptr = &fill_value;
+		// null fill_value
+		std::fill(reinterpret_cast<unsigned char*>(fill_value_ptr), reinterpret_cast<unsigned char*>(fill_value_ptr) + sizeof(cache_line_buffer), 0);
+		// set to flag false
+		*reinterpret_cast<size_t*>(fill_value_ptr) = FLAG_FALSE;
+		// set all flags to fill_value
+		std::fill(flags, flags + msg_buffers, fill_value);
+	}
+
+	static communicator* instance_;
+
+	node_t ham_process_count; // number of participating processes
+	node_t ham_address; // this processes' address
+	node_t ham_host_address; // the address of the host process
+	std::string shm_name; // prefix of the segment names
+	size_t msg_size; // size of each message buffer, including the size header
+	size_t msg_buffers; // number of message buffers per peer and direction
+
+	// array of peers, index is peer address
+	shm_peer* peers;
+};
+
+template<typename T>
+buffer_ptr<T>::buffer_ptr() : buffer_ptr(nullptr, net::communicator::this_node()) { }
+
+template<typename T>
+T& buffer_ptr<T>::operator[](size_t i)
+{
+	assert(node_ == net::communicator::this_node());
+	return ptr_[i];
+}
+
+} // namespace net
+} // namespace ham
+
+#endif // ham_net_communicator_shm_hpp
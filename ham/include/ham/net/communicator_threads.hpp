@@ -0,0 +1,471 @@
+// Copyright (c) 2013-2019 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ham_net_communicator_threads_hpp
+#define ham_net_communicator_threads_hpp
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring> // memcpy
+#include <cstdlib> // posix_memalign
+#include <mutex>
+#include <new> // placement new
+#include <thread>
+#include <unistd.h> // gethostname
+
+#include "ham/misc/constants.hpp"
+#include "ham/misc/options.hpp"
+#include "ham/misc/resource_pool.hpp"
+#include "ham/misc/types.hpp"
+#include "ham/util/debug.hpp"
+#include "ham/util/log.hpp"
+
+namespace ham {
+namespace net {
+
+template<typename T>
+class buffer_ptr
+{
+public:
+	buffer_ptr();
+	buffer_ptr(T* ptr, node_t node) : ptr_(ptr), node_(node) { }
+
+	T* get() const { return ptr_; }
+	node_t node() const { return node_; }
+
+	// element access
+	T& operator[](size_t i);
+
+	// basic pointer arithmetic to address sub-buffers
+	buffer_ptr<T> operator+(size_t off)
+	{
+		return buffer_ptr(ptr_ + off, node_);
+	}
+
+private:
+	T* ptr_; // address inside the shared address space, node_ is the logical owner
+	node_t node_;
+};
+
+class node_descriptor
+{
+public:
+	const char* name() const { return name_; }
+
+private:
+	static constexpr size_t name_length_ {256};
+	char name_[name_length_];
+
+	friend class communicator;
+};
+
+class communicator_options : public ham::detail::options
+{
+public:
+	communicator_options(int* argc_ptr, char** argv_ptr[]) : options(argc_ptr, argv_ptr)
+	{
+		// add backend-specific options
+		app_.add_option("--ham-process-count", ham_process_count_, "Number of nodes the job consists of (number of target threads + 1).");
+
+		// NOTE: no further inheritance or adding
+		parse();
+	}
+
+	// command line argument getters
+	const node_t& ham_process_count() const { return ham_process_count_; }
+
+private:
+	node_t ham_process_count_ = 2; // number of participating nodes, i.e. the host thread and the target threads
+};
+
+// NOTE: this communicator runs all offload targets as threads inside the host process,
+//       it is meant for measuring the software overhead of the active message layer without transport costs,
+//       and as a zero-setup back-end for testing
+//       messages use the one-sided flag protocol of the SCIF communicator on lock-free single-producer/single-consumer channels
+//       buffer_ptr addresses are valid in all nodes, data transfers are a memcpy
+//       the runtime starts one thread per target (see runtime::runtime()), which calls attach() before entering its receive loop
+class communicator {
+public:
+	// NOTE: the number of buffers is only known at runtime, so the special values are taken from the top of the index range
+	enum : size_t {
+		NO_BUFFER_INDEX = SIZE_MAX - 1, // invalid buffer index
+		FLAG_FALSE = SIZE_MAX // special value, outside normal index range
+	};
+
+	// externally used interface of request must be shared across all communicator-implementations
+	struct request {
+
+		request() : target_buffer_index(NO_BUFFER_INDEX) {} // instantiate invalid
+		request(node_t target_node, size_t target_buffer_index, node_t source_node, size_t source_buffer_index)
+		 : target_node(target_node), target_buffer_index(target_buffer_index), source_node(source_node), source_buffer_index(source_buffer_index)
+		{}
+
+		bool test() const
+		{
+			return communicator::instance().test_result_flag(target_node, source_buffer_index);
+		}
+
+		void* get() const // blocks
+		{
+			return communicator::instance().recv_result_msg(target_node, source_buffer_index); // we wait for the target thread, to write into our buffer/flag
+		}
+
+		// the compact part of this request, that is sent along with a message, see communicator::send_result()
+		reply_descriptor reply() const
+		{
+			return { source_node, valid() ? static_cast<uint32_t>(source_buffer_index) : static_cast<uint32_t>(reply_descriptor::NO_REPLY) };
+		}
+
+		bool valid() const
+		{
+			return target_buffer_index != NO_BUFFER_INDEX;
+		}
+
+		node_t target_node;
+		size_t target_buffer_index; // for sending to target node
+		node_t source_node;
+		size_t source_buffer_index; // for receiving from target node
+	};
+
+	typedef request& request_reference_type;
+	typedef const request& request_const_reference_type;
+
+	communicator(communicator_options& comm_options)
+	 : ham_process_count(comm_options.ham_process_count()),
+	   msg_size(comm_options.msg_size()),
+	   msg_buffers(comm_options.msg_buffers())
+	{
+		instance_ = this;
+		this_node_ = ham_host_address; // the constructing thread is the host
+
+		HAM_DEBUG( HAM_LOG << "FLAG_FALSE = " << FLAG_FALSE << ", NO_BUFFER_INDEX = " << NO_BUFFER_INDEX << std::endl; )
+
+		gethostname(node_description.name_, node_descriptor::name_length_);
+		node_description.name_[node_descriptor::name_length_ - 1] = 0x0; // null terminate, in case the name was truncated
+
+		// one channel per target, index is the target's address
+		channels = new channel[ham_process_count];
+
+		for (node_t i = 0; i < ham_process_count; ++i)
+		{
+			if (i == ham_host_address)
+				continue;
+
+			channel& ch = channels[i];
+			ch.to_target_buffers = allocate_buffer<char>(msg_buffers * msg_size, ham_host_address).get();
+			ch.to_host_buffers = allocate_buffer<char>(msg_buffers * msg_size, ham_host_address).get();
+			ch.to_target_flags = allocate_flags();
+			ch.to_host_flags = allocate_flags();
+
+			// fill resource pools
+			for (size_t j = msg_buffers; j > 0; --j) {
+				ch.remote_buffer_pool.add(j-1);
+				ch.local_buffer_pool.add(j-1);
+			}
+
+			// allocate the first request to be used for the next send
+			allocate_next_request(i);
+		}
+
+		if (comm_options.print_footprint())
+			HAM_LOG << "communicator: " << msg_buffers << " message buffers of " << msg_size << " B per target and direction, footprint per target: " << (2 * msg_buffers * (msg_size + sizeof(flag))) << " B" << std::endl;
+	}
+
+	~communicator()
+	{
+		HAM_DEBUG( HAM_LOG << "~communicator" << std::endl; )
+
+		for (node_t i = 0; i < ham_process_count; ++i)
+		{
+			if (i == ham_host_address)
+				continue;
+
+			channel& ch = channels[i];
+			free(ch.to_target_buffers);
+			free(ch.to_host_buffers);
+			free(ch.to_target_flags); // NOTE: flags are trivially destructible
+			free(ch.to_host_flags);
+		}
+
+		delete [] channels;
+	}
+
+	// must be called by each target thread before using the communicator
+	void attach(node_t node)
+	{
+		assert(node != ham_host_address && node < ham_process_count);
+		this_node_ = node;
+	}
+
+private:
+	// pre-allocates the next request and modifies the target's channel data
+	const request& allocate_next_request(node_t remote_node)
+	{
+		HAM_DEBUG( HAM_LOG << "communicator::allocate_next_request(): remote_node = " << remote_node << std::endl; )
+
+		const size_t remote_buffer_index = channels[remote_node].remote_buffer_pool.allocate();
+		const size_t local_buffer_index = channels[remote_node].local_buffer_pool.allocate();
+
+		channels[remote_node].next_request = { remote_node, remote_buffer_index, ham_host_address, local_buffer_index };
+
+		return channels[remote_node].next_request;
+	}
+
+public:
+	request allocate_request(node_t remote_node)
+	{
+		assert(this_node_ == ham_host_address); // only host threads send messages
+		// NOTE: each message carries the index of the next one, so concurrent senders to the same target are serialised,
+		//       the lock is held from here until commit_msg() signals the message belonging to the returned request
+		channels[remote_node].send_mutex.lock();
+		// there is always one pre_allocated request, that corresponds to the next buffer index written to the receiver in the last send
+		return channels[remote_node].next_request;
+	}
+
+	// like allocate_request(), but returns an invalid request instead of over-allocating, if all buffers to remote_node are in use
+	request try_allocate_request(node_t remote_node)
+	{
+		assert(this_node_ == ham_host_address); // only host threads send messages
+		channel& ch = channels[remote_node];
+		ch.send_mutex.lock();
+		// NOTE: commit_msg() pre-allocates the next request, so it needs one free buffer on both sides
+		if (ch.remote_buffer_pool.empty() || ch.local_buffer_pool.empty()) {
+			ch.send_mutex.unlock();
+			return request();
+		}
+		return ch.next_request;
+	}
+
+	void free_request(request_reference_type req)
+	{
+		assert(req.source_node == this_node_);
+
+		channel& ch = channels[req.target_node];
+
+		// reset flags
+		ch.to_host_flags[req.source_buffer_index].value.store(FLAG_FALSE, std::memory_order_relaxed);
+		ch.to_target_flags[req.target_buffer_index].value.store(FLAG_FALSE, std::memory_order_relaxed);
+
+		// pool indices
+		ch.remote_buffer_pool.free(req.target_buffer_index);
+		ch.local_buffer_pool.free(req.source_buffer_index);
+
+		// invalidate request
+		req.target_buffer_index = NO_BUFFER_INDEX;
+	}
+
+	// two-phase send, 1st step: returns the target's buffer belonging to req, in which the message can be constructed in place
+	void* reserve_msg_buffer(request_reference_type req)
+	{
+		return channels[req.target_node].to_target_buffers + req.target_buffer_index * msg_size;
+	}
+
+	// two-phase send, 2nd step: signals the target that the message inside reserve_msg_buffer(req) is complete
+	void commit_msg(request_reference_type req, size_t size)
+	{
+		HAM_UNUSED_VAR(size); // NOTE: the message is not copied, so there is no need for a size header
+		const request& next_req = allocate_next_request(req.target_node); // pre-allocate-request for the next send, because we set this index on the remote size
+
+		HAM_DEBUG( HAM_LOG << "communicator::commit_msg(): " <<
+			"request(" << req.target_node << ", " << req.target_buffer_index << ", " << req.source_node << ", " << req.source_buffer_index << ")" << std::endl );
+
+		// signal the target that the message has been written, and transfer the next buffer/flag index in the process
+		channels[req.target_node].to_target_flags[req.target_buffer_index].value.store(next_req.target_buffer_index, std::memory_order_release);
+
+
+		channels[req.target_node].send_mutex.unlock(); // locked in allocate_request()
+	}
+
+	void send_msg(request_reference_type req, void* msg, size_t size)
+	{
+		memcpy(reserve_msg_buffer(req), msg, size);
+		commit_msg(req, size);
+	}
+
+	// receive offload messages from the host, called by target threads
+	void* recv_msg_host(void* msg = nullptr, size_t size = 0)
+	{
+		HAM_UNUSED_VAR(msg);
+		HAM_UNUSED_VAR(size);
+		channel& ch = channels[this_node_];
+		const size_t buffer_index = ch.next_flag;
+		HAM_DEBUG( HAM_LOG << "communicator::recv_msg_host(): using buffer index: " << buffer_index << std::endl; )
+
+		const size_t next = poll(ch.to_target_flags[buffer_index]);
+		ch.next_flag = next; // the flag contains the next buffer index to poll on
+
+		return ch.to_target_buffers + buffer_index * msg_size; // safe until the host frees the request belonging to this buffer
+	}
+
+	// sends the result of a message back to its sender, called by the receiver of the message
+	void send_result(const reply_descriptor& reply, void* result_msg, size_t size)
+	{
+		assert(reply.valid() && reply.source_node == ham_host_address);
+		send_result_msg(this_node_, reply.source_buffer_index, result_msg, size); // NOTE: the channel belongs to the calling target thread
+	}
+
+	// trigger receiving the result of size byte on the sending side
+	void recv_result(request_reference_type req, size_t size)
+	{
+		HAM_UNUSED_VAR(req);
+		HAM_UNUSED_VAR(size);
+		// nothing todo here, since this communicator implementation uses one-sided communication
+		// the data is already where it is expected (in the buffer referenced in req)
+		return;
+	}
+
+private:
+	void send_result_msg(node_t target_node, size_t buffer_index, void* msg, size_t size)
+	{
+		channel& ch = channels[target_node];
+		memcpy(ch.to_host_buffers + buffer_index * msg_size, msg, size);
+		ch.to_host_flags[buffer_index].value.store(NO_BUFFER_INDEX, std::memory_order_release); // results carry no next index
+	}
+
+	void* recv_result_msg(node_t target_node, size_t buffer_index)
+	{
+		channel& ch = channels[target_node];
+		poll(ch.to_host_flags[buffer_index]);
+		return ch.to_host_buffers + buffer_index * msg_size; // we directly return our buffer here, which is safe, since it can only be re-used after being freed by the future which returns the result by value to the user
+	}
+
+	bool test_result_flag(node_t target_node, size_t buffer_index)
+	{
+		return channels[target_node].to_host_flags[buffer_index].value.load(std::memory_order_acquire) != FLAG_FALSE; // set from the other side by send_result
+	}
+
+public:
+	template<typename T>
+	void send_data(T* local_source, buffer_ptr<T>& remote_dest, size_t size)
+	{
+		HAM_DEBUG( HAM_LOG << "communicator::send_data(): copying " << size << " elements from " << local_source << " to " << remote_dest.get() << " on node " << remote_dest.node() << std::endl; )
+		if (local_source != remote_dest.get())
+			memcpy(static_cast<void*>(remote_dest.get()), static_cast<const void*>(local_source), size * sizeof(T));
+	}
+
+	template<typename T>
+	void recv_data(buffer_ptr<T>& remote_source, T* local_dest, size_t size)
+	{
+		HAM_DEBUG( HAM_LOG << "communicator::recv_data(): copying " << size << " elements from " << remote_source.get() << " on node " << remote_source.node() << " to " << local_dest << std::endl; )
+		if (local_dest != remote_source.get())
+			memcpy(static_cast<void*>(local_dest), static_cast<const void*>(remote_source.get()), size * sizeof(T));
+	}
+
+	template<typename T>
+	buffer_ptr<T> allocate_buffer(const size_t n, node_t source_node)
+	{
+		HAM_UNUSED_VAR(source_node);
+		// NOTE: no ctor calls (buffer vs. array)
+		T* ptr = nullptr;
+		int err = posix_memalign((void**)&ptr, constants::CACHE_LINE_SIZE, n * sizeof(T));
+		HAM_UNUSED_VAR(err);
+		assert(err == 0);
+		return buffer_ptr<T>(ptr, this_node_);
+	}
+
+	template<typename T>
+	void free_buffer(buffer_ptr<T> ptr)
+	{
+		// NOTE: no ctor calls (buffer vs. array)
+		free((void*)ptr.get());
+	}
+
+	static const node_descriptor& get_node_description(node_t node)
+	{
+		HAM_UNUSED_VAR(node);
+		return instance().node_description; // all nodes share the same process
+	}
+
+	// size of the message buffers, see --ham-msg-size
+	static size_t max_msg_size() { return instance().msg_size; }
+
+	// number of message buffers per peer, see --ham-msg-buffers
+	static size_t num_msg_buffers() { return instance().msg_buffers; }
+
+	static communicator& instance() { return *instance_; }
+	static bool initialised() { return instance_ != nullptr; };
+	static node_t this_node() { return this_node_; }
+	static size_t num_nodes() { return instance().ham_process_count; }
+	bool is_host() const { return this_node_ == ham_host_address; }
+	bool is_host(node_t node) const { return node == ham_host_address; }
+
+private:
+	// busy polling for a bit, then yield, since the host and the target threads might share cores
+	static constexpr size_t POLL_SPIN_COUNT = 1024;
+
+	struct alignas(constants::CACHE_LINE_SIZE) flag {
+		flag() : value(FLAG_FALSE) {}
+		std::atomic<size_t> value;
+	};
+
+	// NOTE: new does not respect the extended alignment of flag in C++11
+	flag* allocate_flags()
+	{
+		flag* flags = allocate_buffer<flag>(msg_buffers, ham_host_address).get();
+		for (size_t i = 0; i < msg_buffers; ++i)
+			new (&flags[i]) flag();
+		return flags;
+	}
+
+	// returns the value of f, once it is set
+	static size_t poll(flag& f)
+	{
+		size_t spin = 0;
+		size_t value;
+		while ((value = f.value.load(std::memory_order_acquire)) == FLAG_FALSE) // the message is visible after the flag
+		{
+			if (++spin > POLL_SPIN_COUNT)
+				std::this_thread::yield();
+		}
+		return value;
+	}
+
+	// host <-> target channel, seen from the host
+	struct channel {
+		request next_request; // the next request, belonging to next flag, only used by the host
+		std::mutex send_mutex; // held from allocate_request() until commit_msg(), only used by the host
+		size_t next_flag = 0; // the next flag to poll on, only used by the target
+
+		char* to_target_buffers = nullptr; // the host constructs messages to the target inside these msg_buffers buffers of msg_size
+		flag* to_target_flags = nullptr; // the host signals a message is complete via these flags, the target polls on them
+
+		char* to_host_buffers = nullptr; // the target writes results into these msg_buffers buffers of msg_size
+		flag* to_host_flags = nullptr; // the target signals a result is complete via these flags, the host polls on them
+
+		// needed by the host to manage which buffers are in use and which are free
+		detail::resource_pool<size_t> remote_buffer_pool;
+		detail::resource_pool<size_t> local_buffer_pool;
+	};
+
+	static communicator* instance_;
+	static thread_local node_t this_node_; // the address of the calling thread
+
+	const node_t ham_host_address = 0; // the address of the host thread
+	node_t ham_process_count; // number of participating nodes
+	size_t msg_size; // size of each message buffer
+	size_t msg_buffers; // number of message buffers per target and direction
+	node_descriptor node_description;
+
+	// array of channels, index is the target's address
+	channel* channels;
+};
+
+template<typename T>
+buffer_ptr<T>::buffer_ptr() : buffer_ptr(nullptr, net::communicator::this_node()) { }
+
+template<typename T>
+T& buffer_ptr<T>::operator[](size_t i)
+{
+	assert(node_ == net::communicator::this_node());
+	return ptr_[i];
+}
+
+} // namespace net
+} // namespace ham
+
+#endif // ham_net_communicator_threads_hpp
@@ -127,15 +127,14 @@ public:
 
 		void* get() const // blocks
 		{
-			return communicator::instance().recv_msg(target_node, source_buffer_index); // we wait for the remote side, to write into our buffer/flag
+			return communicator::instance().recv_msg(target_node, source_buffer_index, nullptr, result_size); // we wait for the remote side, to write into our buffer/flag
 		}
 
 
-		template<class T>
-		void send_result(T* result_msg, size_t size)
+		// the compact part of this request, that is sent along with a message, see communicator::send_result()
+		reply_descriptor reply() const
 		{
-			assert(communicator::this_node() == target_node); // this assert fails if send_result is called from the wrong side
-			communicator::instance().send_msg(source_node, source_buffer_index, NO_BUFFER_INDEX, result_msg, size);
+			return { source_node, valid() ? static_cast<uint32_t>(source_buffer_index) : static_cast<uint32_t>(reply_descriptor::NO_REPLY) };
 		}
 
 		bool valid() const
@@ -147,6 +146,7 @@ public:
 		size_t target_buffer_index; // for sending to target node
 		node_t source_node;
 		size_t source_buffer_index; // for receiving from target node
+		size_t result_size = 0; // expected size of the result, set by recv_result(), 0 if unknown
 	};
 	
 	
@@ -192,6 +192,24 @@ public:
 		free((void*)ptr.get());
 	}
 
+	// sends the result of a message back to its sender, called by the receiver of the message
+	void send_result(const reply_descriptor& reply, void* result_msg, size_t size)
+	{
+		assert(reply.valid());
+		Derived::instance().send_msg(reply.source_node, reply.source_buffer_index, NO_BUFFER_INDEX, result_msg, size);
+	}
+
+	// trigger receiving the result of size byte on the sending side
+	void recv_result(request_reference_type req, size_t size)
+	{
+		// nothing to trigger, since this communicator implementation uses one-sided communication,
+		// but the expected size allows receiving the result with fewer remote reads, see recv_msg()
+		req.result_size = size;
+	}
+
+	static size_t max_msg_size() { return constants::MSG_SIZE; } // NOTE: fixed, see constants.hpp
+	static size_t num_msg_buffers() { return constants::MSG_BUFFERS; } // NOTE: fixed, see constants.hpp
+
 	size_t round_to_full_pages(size_t size, size_t page_size) 
 	{
 		return size % page_size == 0 ? size : ((size / page_size) + 1) * page_size;
@@ -125,6 +125,15 @@ public:
 		return peers[remote_node].next_request;
 	}
 
+	// like allocate_request(), but returns an invalid request if all buffers to remote_node are in use
+	request try_allocate_request(node_t remote_node)
+	{
+		// NOTE: commit_msg() pre-allocates the next request, so it needs one free buffer on both sides
+		if (peers[remote_node].remote_buffer_pool.empty() || peers[remote_node].local_buffer_pool.empty())
+			return request();
+		return allocate_request(remote_node);
+	}
+
 	void free_request(request_reference_type req)
 	{
 		assert(req.source_node == ham_address);
@@ -146,32 +155,54 @@ public:
 		req.target_buffer_index = NO_BUFFER_INDEX;
 	}
 
-	void send_msg(request_reference_type req, void* msg, size_t size)
+	// two-phase send, 1st step: returns the remote buffer belonging to req, in which the message can be constructed in place
+	void* reserve_msg_buffer(request_reference_type req)
+	{
+		return msg_payload(req.target_node, req.target_buffer_index);
+	}
+
+	// two-phase send, 2nd step: signals the receiver that the message of size byte inside reserve_msg_buffer(req) is complete
+	void commit_msg(request_reference_type req, size_t size)
 	{
 		const request& next_req = allocate_next_request(req.target_node); // pre-allocate-request for the next send, because we set this index on the remote size
 
-		HAM_DEBUG( HAM_LOG << "communicator(VE)::send_msg(): " <<
+		HAM_DEBUG( HAM_LOG << "communicator(VE)::commit_msg(): " <<
 			"request(" << req.target_node << ", " << req.target_buffer_index << ", " << req.source_node << ", " << req.source_buffer_index << ")" << std::endl );
 
-		send_msg(req.target_node, req.target_buffer_index, next_req.target_buffer_index, msg, size);
-//		send_msg(req.target_node, req.target_buffer_index, peers[req.target_node].remote_buffer_pool.next(), msg, size);
+		commit_msg(req.target_node, req.target_buffer_index, next_req.target_buffer_index, size);
+	}
+
+	void send_msg(request_reference_type req, void* msg, size_t size)
+	{
+		memcpy(reserve_msg_buffer(req), msg, size);
+		commit_msg(req, size);
 	}
 
 private:
+	// the message is located behind the size header inside the remote buffer
+	void* msg_payload(node_t node, size_t buffer_index)
+	{
+		return reinterpret_cast<char*>(&peers[node].remote_buffers[buffer_index]) + sizeof(size_t);
+	}
+
 	void send_msg(node_t node, size_t buffer_index, size_t next_buffer_index, void* msg, size_t size)
 	{
-		HAM_DEBUG( HAM_LOG << "communicator(VE)::send_msg(): node =  " << node << std::endl; )
-		HAM_DEBUG( HAM_LOG << "communicator(VE)::send_msg(): remote buffer index = " << buffer_index << std::endl; )
+		memcpy(msg_payload(node, buffer_index), msg, size);
+		commit_msg(node, buffer_index, next_buffer_index, size);
+	}
+
+	void commit_msg(node_t node, size_t buffer_index, size_t next_buffer_index, size_t size)
+	{
+		HAM_DEBUG( HAM_LOG << "communicator(VE)::commit_msg(): node =  " << node << std::endl; )
+		HAM_DEBUG( HAM_LOG << "communicator(VE)::commit_msg(): remote buffer index = " << buffer_index << std::endl; )
 
 		char* remote_buffer = reinterpret_cast<char*>(&peers[node].remote_buffers[buffer_index]);
 		volatile size_t* remote_flag = reinterpret_cast<size_t*>(&peers[node].remote_flags[buffer_index]);
-		HAM_DEBUG( HAM_LOG << "communicator(VE)::send_msg(): remote buffer is: " << (void*)remote_buffer << std::endl; )
+		HAM_DEBUG( HAM_LOG << "communicator(VE)::commit_msg(): remote buffer is: " << (void*)remote_buffer << std::endl; )
 
-		HAM_DEBUG( HAM_LOG << "communicator(VE)::send_msg(): sending message of size: " << size << std::endl; )
-		// copy to remote memory
+		HAM_DEBUG( HAM_LOG << "communicator(VE)::commit_msg(): sending message of size: " << size << std::endl; )
+		// the message is already in remote memory, add the size header
 		memcpy((char*)remote_buffer, (void*)&size, sizeof(size_t)); // size = header
-
-		memcpy((char*)remote_buffer + sizeof(size_t), msg , size);
 //		_mm_sfence(); // NOTE: intel intrinsic: store fence, make changes visible on the remote site to which we wrote
 
 		*remote_flag = next_buffer_index; // signal remote side that the message has been written, and transfer the next buffer/flag index in the process
@@ -221,15 +252,6 @@ public:
 		return recv_msg(ham_host_address, NO_BUFFER_INDEX, msg, size);
 	}
 	
-	// trigger receiving the result of a message on the sending side
-	void recv_result(request_reference_type req)
-	{
-		HAM_UNUSED_VAR(req);
-		// nothing to do here, since this communicator implementation uses one-sided communication
-		// the data is already where it is expected (in the buffer referenced in req)
-		return;
-	}
-
 	template<typename T>
 	void send_data(T* local_source, buffer_ptr<T>& remote_dest, size_t size)
 	{
@@ -9,6 +9,7 @@
 #include "ham/net/communicator_veo_base.hpp"
 #include "ham/misc/options.hpp"
 
+#include <mutex>
 #include <algorithm>
 #include <string>
 #include <string.h> // strncpy
@@ -34,6 +35,9 @@ public:
 		// we are definitely the host
 		assert(is_host());
 
+		if (!comm_options.default_msg_config())
+			HAM_LOG << "communicator::communicator(): warning: --ham-msg-size and --ham-msg-buffers are not supported by this backend, using " << constants::MSG_BUFFERS << " buffers of " << constants::MSG_SIZE << " B" << std::endl;
+
 		// TODO: convenience: generate default ve_node_list, if arg not provided
 		if (veo_ve_nodes.empty())
 			HAM_LOG << "communicator(VH)::communicator: error: please provide --ham-veo-ve-nodes with --ham-process-count minus 1 comma-separated values." << std::endl;
@@ -91,6 +95,7 @@ public:
 				
 				// allocate local communication buffers
 				peer.recv_buffers = allocate_buffer<msg_buffer>(constants::MSG_BUFFERS, ham_address); // local host memory
+				peer.send_buffers = allocate_buffer<msg_buffer>(constants::MSG_BUFFERS, ham_address); // local host memory
 
 				// allocate communication buffers on the target
 				err = veo_alloc_mem(peer.veo_proc, &peer.local_buffers_addr, sizeof(msg_buffer) * constants::MSG_BUFFERS);
@@ -280,6 +285,9 @@ std::cerr << "got node desc" << std::endl;
 				err = veo_free_mem(peer.veo_proc, peer.remote_flags_addr);
 				assert(err == 0);
 
+				free_buffer(peer.recv_buffers);
+				free_buffer(peer.send_buffers);
+
 
 				err = veo_context_close(peer.veo_main_context);
 				assert(err == 0);
@@ -323,6 +331,9 @@ protected:
 public:
 	request allocate_request(node_t remote_node)
 	{
+		// NOTE: each message carries the index of the next one, so concurrent senders to the same peer are serialised,
+		//       the lock is held from here until commit_msg() sends the message belonging to the returned request
+		peers[remote_node].send_mutex.lock();
 		{
 			HAM_DEBUG(
 			HAM_LOG << "communicator(VH)::allocate_request(): remote_node = " << remote_node << std::endl;
@@ -334,6 +345,19 @@ public:
 		return peers[remote_node].next_request;
 	}
 
+	// like allocate_request(), but returns an invalid request instead of over-allocating, if all buffers to remote_node are in use
+	request try_allocate_request(node_t remote_node)
+	{
+		veo_peer& peer = peers[remote_node];
+		peer.send_mutex.lock();
+		// NOTE: commit_msg() pre-allocates the next request, so it needs one free buffer on both sides
+		if (peer.remote_buffer_pool.empty() || peer.local_buffer_pool.empty()) {
+			peer.send_mutex.unlock();
+			return request();
+		}
+		return peer.next_request;
+	}
+
 	void free_request(request_reference_type req)
 	{
 		assert(req.source_node == ham_address);
@@ -363,50 +387,70 @@ public:
 		req.target_buffer_index = NO_BUFFER_INDEX;
 	}
 
-	void send_msg(request_reference_type req, void* msg, size_t size)
+	// two-phase send, 1st step: returns the local send buffer belonging to req, in which the message can be constructed in place
+	void* reserve_msg_buffer(request_reference_type req)
+	{
+		return msg_payload(req.target_node, req.target_buffer_index);
+	}
+
+	// two-phase send, 2nd step: writes the message of size byte inside reserve_msg_buffer(req) to the target
+	void commit_msg(request_reference_type req, size_t size)
 	{
 		const request& next_req = allocate_next_request(req.target_node); // pre-allocate-request for the next send, because we set this index on the remote size
 
-		HAM_DEBUG( HAM_LOG << "communicator(VH)::send_msg(): " <<
+		HAM_DEBUG( HAM_LOG << "communicator(VH)::commit_msg(): " <<
 			"request(" << req.target_node << ", " << req.target_buffer_index << ", " << req.source_node << ", " << req.source_buffer_index << ")" << std::endl );
 
-		send_msg(req.target_node, req.target_buffer_index, next_req.target_buffer_index, msg, size);
-		//send_msg(req.target_node, req.target_buffer_index, peers[req.target_node].remote_buffer_pool.next(), msg, size);
+		commit_msg(req.target_node, req.target_buffer_index, next_req.target_buffer_index, size);
+
+		peers[req.target_node].send_mutex.unlock(); // locked in allocate_request()
+	}
+
+	void send_msg(request_reference_type req, void* msg, size_t size)
+	{
+		memcpy(reserve_msg_buffer(req), msg, size);
+		commit_msg(req, size);
 	}
 
 protected:
+	// the message is located behind the size header inside the local send buffer
+	void* msg_payload(node_t node, size_t buffer_index)
+	{
+		return reinterpret_cast<char*>(&peers[node].send_buffers[buffer_index]) + sizeof(size_t);
+	}
+
+	void send_msg(node_t node, size_t buffer_index, size_t next_buffer_index, void* msg, size_t size)
+	{
+		memcpy(msg_payload(node, buffer_index), msg, size);
+		commit_msg(node, buffer_index, next_buffer_index, size);
+	}
+
 	// NOTE: we write into the target memory here via VEO, coming from the SCIF names
 	//       local_buffers on the target are for receiving on the target
 	//       remote_buffers on the target are for sending from the target
-	//       => send_msg writes into local_buffers on the host side
-	void send_msg(node_t node, size_t buffer_index, size_t next_buffer_index, void* msg, size_t size)
+	//       => commit_msg writes into local_buffers on the host side
+	void commit_msg(node_t node, size_t buffer_index, size_t next_buffer_index, size_t size)
 	{
-		HAM_DEBUG( HAM_LOG << "communicator(VH)::send_msg(): node =  " << node << std::endl; )
-		HAM_DEBUG( HAM_LOG << "communicator(VH)::send_msg(): remote buffer index = " << buffer_index << std::endl; )
+		HAM_DEBUG( HAM_LOG << "communicator(VH)::commit_msg(): node =  " << node << std::endl; )
+		HAM_DEBUG( HAM_LOG << "communicator(VH)::commit_msg(): remote buffer index = " << buffer_index << std::endl; )
 
 		uint64_t target_buffer_addr = peers[node].local_buffers_addr + sizeof(msg_buffer) * buffer_index;
 		uint64_t target_flag_addr = peers[node].local_flags_addr + sizeof(cache_line_buffer) * buffer_index;
-		
-		HAM_DEBUG( HAM_LOG << "communicator(VH)::send_msg(): sending message size: " << size << std::endl; )
-		// copy to remote memory
-//		memcpy((char*)remote_buffer, (void*)&size, sizeof(size_t)); // size = header
-		// TODO: generalise and put into helper function buffer_index to offset
-		errno_handler(
-			veo_write_mem(peers[node].veo_proc, target_buffer_addr, (const void*)&size, sizeof(size_t)), 
-			"veo_write_mem(size) inside send_msg()"
-		);
+		char* send_buffer = reinterpret_cast<char*>(&peers[node].send_buffers[buffer_index]);
 
-		HAM_DEBUG( HAM_LOG << "communicator(VH)::send_msg(): sending message" << std::endl; )
+		HAM_DEBUG( HAM_LOG << "communicator(VH)::commit_msg(): sending message of size: " << size << std::endl; )
+		// size header and message are contiguous in the send buffer, which allows a single write to remote memory
+		memcpy(send_buffer, (void*)&size, sizeof(size_t)); // size = header
 		errno_handler(
-			veo_write_mem(peers[node].veo_proc, target_buffer_addr + sizeof(size_t), (const void*)msg, size), 
-			"veo_write_mem(msg) inside send_msg()"
+			veo_write_mem(peers[node].veo_proc, target_buffer_addr, (const void*)send_buffer, sizeof(size_t) + size),
+			"veo_write_mem(size + msg) inside commit_msg()"
 		);
 //		_mm_sfence(); // NOTE: intel intrinsic: store fence, make changes visible on the remote site to which we wrote
 
-		HAM_DEBUG( HAM_LOG << "communicator(VH)::send_msg(): setting flag at " << target_flag_addr << " to next_buffer_index = " << next_buffer_index << std::endl; )
+		HAM_DEBUG( HAM_LOG << "communicator(VH)::commit_msg(): setting flag at " << target_flag_addr << " to next_buffer_index = " << next_buffer_index << std::endl; )
 		errno_handler(
 			veo_write_mem(peers[node].veo_proc, target_flag_addr, (const void*)&next_buffer_index, sizeof(size_t)), 
-			"veo_write_mem(flag) inside send_msg()"
+			"veo_write_mem(flag) inside commit_msg()"
 		);
 //		_mm_sfence(); // NOTE: intel intrinsic: store fence, make changes visible on the remote site
 	}
@@ -438,6 +482,20 @@ protected:
 		if (local_flag != NO_BUFFER_INDEX) // the flag contains the next buffer index to poll on
 			peers[node].next_flag = local_flag;
 
+		// buffer to read our msg to (without the size)
+		char* recv_buffer = reinterpret_cast<char*>(&peers[node].recv_buffers.get()[buffer_index]);
+
+		// the size of results is known by the caller, so the size header and the message can be read at once
+		if (size > 0 && sizeof(size_t) + size <= sizeof(msg_buffer)) {
+			errno_handler(
+				veo_read_mem(peers[node].veo_proc, (void*)recv_buffer, target_buffer_addr, sizeof(size_t) + size),
+				"veo_read_mem(size + msg) inside recv_msg()"
+			);
+			HAM_DEBUG( HAM_LOG << "communicator(VH)::recv_msg(): received msg of expected size: " << size << std::endl; )
+			assert(*reinterpret_cast<size_t*>(recv_buffer) == size);
+			return recv_buffer + sizeof(size_t); // NOTE: safe, see below
+		}
+
 		// copy size from recv buffer
 		//memcpy((void*)&size, (char*)local_buffer, sizeof(size_t));
 		errno_handler(
@@ -450,8 +508,6 @@ protected:
 
 //		_mm_lfence(); // NOTE: intel intrinsic: all prior loads are globally visible
 
-		// buffer to read our msg to (without the size)
-		char* recv_buffer = reinterpret_cast<char*>(&peers[node].recv_buffers.get()[buffer_index]);
 		// TODO: put the message somewhere, a buffer is needed
 		errno_handler(
 			veo_read_mem(peers[node].veo_proc, (void*)recv_buffer, target_buffer_addr + sizeof(size_t), size), 
@@ -484,15 +540,6 @@ public:
 		return recv_msg(ham_host_address, NO_BUFFER_INDEX, msg, size);
 	}
 	
-	// trigger receiving the result of a message on the sending side
-	void recv_result(request_reference_type req)
-	{
-		HAM_UNUSED_VAR(req);
-		// nothing todo here, since this communicator implementation uses one-sided communication
-		// the data is already where it is expected (in the buffer referenced in req)
-		return;
-	}
-
 
 	template<typename T>
 	void send_data(T* local_source, buffer_ptr<T>& remote_dest, size_t size)
@@ -538,6 +585,7 @@ private:
 		{}
 
 		request next_request; // the next request, belonging to next flag
+		std::mutex send_mutex; // held from allocate_request() until commit_msg()
 		size_t next_flag; // flag
 
 		// VEO data
@@ -557,6 +605,8 @@ private:
 
 		// buffer to copy received messages from target to
 		buffer_ptr<msg_buffer> recv_buffers; // local memory, recv_msg copies data to these buffers using veo_read_mem()
+		// buffer to construct messages to the target in, before they are written using veo_write_mem()
+		buffer_ptr<msg_buffer> send_buffers; // local memory, size header + message
 
 		// needed by sender to manage which buffers are in use and which are free
 		// just manages indices, that can be used by
@@ -269,6 +269,15 @@ public:
 		return peers[remote_node].next_request;
 	}
 
+	// like allocate_request(), but returns an invalid request if all buffers to remote_node are in use
+	request try_allocate_request(node_t remote_node)
+	{
+		// NOTE: commit_msg() pre-allocates the next request, so it needs one free buffer on both sides
+		if (peers[remote_node].remote_buffer_pool.empty() || peers[remote_node].local_buffer_pool.empty())
+			return request();
+		return allocate_request(remote_node);
+	}
+
 	void free_request(request_reference_type req)
 	{
 		assert(false); // TODO: is this actually called on VE side?
@@ -293,38 +302,61 @@ public:
 		req.target_buffer_index = NO_BUFFER_INDEX;
 	}
 
-	void send_msg(request_reference_type req, void* msg, size_t size)
+	// two-phase send, 1st step: returns the local DMA send buffer belonging to req, in which the message can be constructed in place
+	void* reserve_msg_buffer(request_reference_type req)
+	{
+		return msg_payload(req.target_node, req.target_buffer_index);
+	}
+
+	// two-phase send, 2nd step: transfers the message of size byte inside reserve_msg_buffer(req) and signals the receiver
+	void commit_msg(request_reference_type req, size_t size)
 	{
 		const request& next_req = allocate_next_request(req.target_node); // pre-allocate-request for the next send, because we set this index on the remote size
 
-		HAM_DEBUG( HAM_LOG << "communicator(VE)::send_msg(): " <<
+		HAM_DEBUG( HAM_LOG << "communicator(VE)::commit_msg(): " <<
 			"request(" << req.target_node << ", " << req.target_buffer_index << ", " << req.source_node << ", " << req.source_buffer_index << ")" << std::endl );
 
-		send_msg(req.target_node, req.target_buffer_index, next_req.target_buffer_index, msg, size);
-		//send_msg(req.target_node, req.target_buffer_index, peers[req.target_node].remote_buffer_pool.next(), msg, size);
+		commit_msg(req.target_node, req.target_buffer_index, next_req.target_buffer_index, size);
+	}
+
+	void send_msg(request_reference_type req, void* msg, size_t size)
+	{
+		memcpy(reserve_msg_buffer(req), msg, size);
+		commit_msg(req, size);
 	}
 
 private:
+	// the message is located behind the size header inside the local send buffer
+	void* msg_payload(node_t node, size_t buffer_index)
+	{
+		return (char*)peers[node].local_send_buffers_addr + buffer_index * sizeof(msg_buffer) + sizeof(size_t);
+	}
+
 	void send_msg(node_t node, size_t buffer_index, size_t next_buffer_index, void* msg, size_t size)
 	{
-		HAM_DEBUG( HAM_LOG << "communicator(VE)::send_msg(): node =  " << node << std::endl; )
-		HAM_DEBUG( HAM_LOG << "communicator(VE)::send_msg(): remote buffer index = " << buffer_index << std::endl; )
-		HAM_DEBUG( HAM_LOG << "communicator(VE)::send_msg(): msg size is: " << size << std::endl; )
+		memcpy(msg_payload(node, buffer_index), msg, size);
+		commit_msg(node, buffer_index, next_buffer_index, size);
+	}
+
+	void commit_msg(node_t node, size_t buffer_index, size_t next_buffer_index, size_t size)
+	{
+		HAM_DEBUG( HAM_LOG << "communicator(VE)::commit_msg(): node =  " << node << std::endl; )
+		HAM_DEBUG( HAM_LOG << "communicator(VE)::commit_msg(): remote buffer index = " << buffer_index << std::endl; )
+		HAM_DEBUG( HAM_LOG << "communicator(VE)::commit_msg(): msg size is: " << size << std::endl; )
 
 		uint64_t remote_recv_flag_vehva = peers[node].remote_recv_flags_vehva + buffer_index * sizeof(size_t);
 		uint64_t remote_recv_buffer_vehva = peers[node].remote_recv_buffers_vehva + buffer_index * sizeof(msg_buffer);
 
 		uint64_t local_send_buffer_vehva = peers[node].local_send_buffers_vehva + buffer_index * sizeof(msg_buffer);
 		void* local_send_buffer_addr = (char*)peers[node].local_send_buffers_addr + buffer_index * sizeof(msg_buffer);
-		HAM_DEBUG( HAM_LOG << "communicator(VE)::send_msg(): remote recv flag SHM offset is: " << (remote_recv_flag_vehva - peers[node].shm_remote_vehva) << std::endl; )
-		HAM_DEBUG( HAM_LOG << "communicator(VE)::send_msg(): remote recv buffer SHM offset is: " << (remote_recv_buffer_vehva - peers[node].shm_remote_vehva) << std::endl; )
+		HAM_DEBUG( HAM_LOG << "communicator(VE)::commit_msg(): remote recv flag SHM offset is: " << (remote_recv_flag_vehva - peers[node].shm_remote_vehva) << std::endl; )
+		HAM_DEBUG( HAM_LOG << "communicator(VE)::commit_msg(): remote recv buffer SHM offset is: " << (remote_recv_buffer_vehva - peers[node].shm_remote_vehva) << std::endl; )
 		
 		// BEGIN: VERSION A
 
 		// DMA message to VH
-		// construct message in local buffer: size + msg
+		// the message is already in the local buffer, add the size header: size + msg
 		memcpy((char*)local_send_buffer_addr, (void*)&size, sizeof(size_t)); // size = header
-		memcpy((char*)local_send_buffer_addr + sizeof(size_t), msg, size);
 		// NOTE: it seems that the size for ve_dma_post_wait() needs to be a multiple of 4
 		constexpr size_t multiple = 4;
 //		const size_t msg_buffer_size = sizeof(size_t) + (size < multiple ? multiple : size ); // assert that size >= 12
@@ -350,7 +382,7 @@ private:
 		// END: VERSION B
 
 		// set flag
-		HAM_DEBUG( HAM_LOG << "communicator(VE)::send_msg(): setting flag to: " << next_buffer_index << std::endl; ) 
+		HAM_DEBUG( HAM_LOG << "communicator(VE)::commit_msg(): setting flag to: " << next_buffer_index << std::endl; ) 
 		ve_inst_shm((void *)remote_recv_flag_vehva, next_buffer_index);
 		ve_inst_fenceSF();
 	}
@@ -446,15 +478,6 @@ public:
 		return recv_msg(ham_host_address, NO_BUFFER_INDEX, msg, size);
 	}
 	
-	// trigger receiving the result of a message on the sending side
-	void recv_result(request_reference_type req)
-	{
-		HAM_UNUSED_VAR(req);
-		// nothing todo here, since this communicator implementation uses one-sided communication
-		// the data is already where it is expected (in the buffer referenced in req)
-		return;
-	}
-
 	template<typename T>
 	void send_data(T* local_source, buffer_ptr<T>& remote_dest, size_t size)
 	{
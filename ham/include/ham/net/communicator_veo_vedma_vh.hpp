@@ -9,6 +9,7 @@
 #include "ham/net/communicator_veo_base.hpp"
 #include "ham/misc/options.hpp"
 
+#include <mutex>
 #include <algorithm>
 #include <string>
 #include <string.h> // strncpy
@@ -41,6 +42,9 @@ public:
 		// we are definitely the host
 		assert(is_host());
 
+		if (!comm_options.default_msg_config())
+			HAM_LOG << "communicator::communicator(): warning: --ham-msg-size and --ham-msg-buffers are not supported by this backend, using " << constants::MSG_BUFFERS << " buffers of " << constants::MSG_SIZE << " B" << std::endl;
+
 		// TODO: convenience: generate default ve_node_list, if arg not provided
 		if (veo_ve_nodes.empty())
 			HAM_LOG << "communicator(VH)::communicator: error: please provide --ham-veo-ve-nodes with --ham-process-count minus 1 comma-separated values." << std::endl;
@@ -363,6 +367,9 @@ protected:
 public:
 	request allocate_request(node_t remote_node)
 	{
+		// NOTE: each message carries the index of the next one, so concurrent senders to the same peer are serialised,
+		//       the lock is held from here until commit_msg() sends the message belonging to the returned request
+		peers[remote_node].send_mutex.lock();
 		{
 			HAM_DEBUG(
 			HAM_LOG << "communicator(VH)::allocate_request(): remote_node = " << remote_node << std::endl;
@@ -374,6 +381,19 @@ public:
 		return peers[remote_node].next_request;
 	}
 
+	// like allocate_request(), but returns an invalid request instead of over-allocating, if all buffers to remote_node are in use
+	request try_allocate_request(node_t remote_node)
+	{
+		veo_peer& peer = peers[remote_node];
+		peer.send_mutex.lock();
+		// NOTE: commit_msg() pre-allocates the next request, so it needs one free buffer on both sides
+		if (peer.remote_buffer_pool.empty() || peer.local_buffer_pool.empty()) {
+			peer.send_mutex.unlock();
+			return request();
+		}
+		return peer.next_request;
+	}
+
 	void free_request(request_reference_type req)
 	{
 		assert(req.source_node == ham_address);
@@ -395,44 +415,67 @@ public:
 		req.target_buffer_index = NO_BUFFER_INDEX;
 	}
 
-	void send_msg(request_reference_type req, void* msg, size_t size)
+	// two-phase send, 1st step: returns the SHM buffer belonging to req, in which the message can be constructed in place
+	void* reserve_msg_buffer(request_reference_type req)
+	{
+		return msg_payload(req.target_node, req.target_buffer_index);
+	}
+
+	// two-phase send, 2nd step: signals the target that the message of size byte inside reserve_msg_buffer(req) is complete
+	void commit_msg(request_reference_type req, size_t size)
 	{
 		const request& next_req = allocate_next_request(req.target_node); // pre-allocate-request for the next send, because we set this index on the remote size
 
-		HAM_DEBUG( HAM_LOG << "communicator(VH)::send_msg(): " <<
+		HAM_DEBUG( HAM_LOG << "communicator(VH)::commit_msg(): " <<
 			"request(" << req.target_node << ", " << req.target_buffer_index << ", " << req.source_node << ", " << req.source_buffer_index << ")" << std::endl );
 
-		send_msg(req.target_node, req.target_buffer_index, next_req.target_buffer_index, msg, size);
-		//send_msg(req.target_node, req.target_buffer_index, peers[req.target_node].remote_buffer_pool.next(), msg, size);
+		commit_msg(req.target_node, req.target_buffer_index, next_req.target_buffer_index, size);
+
+		peers[req.target_node].send_mutex.unlock(); // locked in allocate_request()
+	}
+
+	void send_msg(request_reference_type req, void* msg, size_t size)
+	{
+		memcpy(reserve_msg_buffer(req), msg, size);
+		commit_msg(req, size);
 	}
 
 protected:
+	// the message is located behind the size header inside the SHM buffer
+	void* msg_payload(node_t node, size_t buffer_index)
+	{
+		return reinterpret_cast<char*>(&peers[node].remote_buffers[buffer_index]) + sizeof(size_t);
+	}
+
+	void send_msg(node_t node, size_t buffer_index, size_t next_buffer_index, void* msg, size_t size)
+	{
+		memcpy(msg_payload(node, buffer_index), msg, size);
+		commit_msg(node, buffer_index, next_buffer_index, size);
+	}
+
 	// NOTE: we write into the target memory here via VEO, coming from the SCIF names
 	//       local_buffers on the target are for receiving on the target
 	//       remote_buffers on the target are for sending from the target
-	//       => send_msg writes into local_buffers on the host side
-	void send_msg(node_t node, size_t buffer_index, size_t next_buffer_index, void* msg, size_t size)
+	//       => commit_msg writes into local_buffers on the host side
+	void commit_msg(node_t node, size_t buffer_index, size_t next_buffer_index, size_t size)
 	{
-		HAM_DEBUG( HAM_LOG << "communicator(VH)::send_msg(): node =  " << node << std::endl; )
-		HAM_DEBUG( HAM_LOG << "communicator(VH)::send_msg(): remote buffer index = " << buffer_index << std::endl; )
+		HAM_DEBUG( HAM_LOG << "communicator(VH)::commit_msg(): node =  " << node << std::endl; )
+		HAM_DEBUG( HAM_LOG << "communicator(VH)::commit_msg(): remote buffer index = " << buffer_index << std::endl; )
 
 		// write into local SHM memory
 		char* remote_buffer = reinterpret_cast<char*>(&peers[node].remote_buffers[buffer_index]);
 		volatile size_t* remote_flag = reinterpret_cast<size_t*>(&peers[node].remote_flags[buffer_index]);
-		HAM_DEBUG( HAM_LOG << "communicator(VH)::send_msg(): remote buffer is: " << (void*)remote_buffer << std::endl; )
-		HAM_DEBUG( HAM_LOG << "communicator(VH)::send_msg(): remote flag is: " << (void*)remote_flag << std::endl; )
+		HAM_DEBUG( HAM_LOG << "communicator(VH)::commit_msg(): remote buffer is: " << (void*)remote_buffer << std::endl; )
+		HAM_DEBUG( HAM_LOG << "communicator(VH)::commit_msg(): remote flag is: " << (void*)remote_flag << std::endl; )
 
-		HAM_DEBUG( HAM_LOG << "communicator(VH)::send_msg(): sending message of size: " << size << std::endl; )
-		// copy to remote memory
+		HAM_DEBUG( HAM_LOG << "communicator(VH)::commit_msg(): sending message of size: " << size << std::endl; )
+		// the message is already in SHM, add the size header
 		memcpy((char*)remote_buffer, (void*)&size, sizeof(size_t)); // size = header
 
-		HAM_DEBUG( HAM_LOG << "communicator(VH)::send_msg(): sending message" << std::endl; )
-		memcpy((char*)remote_buffer + sizeof(size_t), msg , size);
-
 		// TODO(maybe): do we need the fences below?
 		_mm_sfence(); // NOTE: intel intrinsic: store fence, make changes visible on the remote site to which we wrote
 
-		HAM_DEBUG( HAM_LOG << "communicator(VH)::send_msg(): setting flag at SHM offset: " << ((uint64_t)remote_flag - (uint64_t)peers[node].shm_local_addr) << " to next_buffer_index = " << next_buffer_index << std::endl; )
+		HAM_DEBUG( HAM_LOG << "communicator(VH)::commit_msg(): setting flag at SHM offset: " << ((uint64_t)remote_flag - (uint64_t)peers[node].shm_local_addr) << " to next_buffer_index = " << next_buffer_index << std::endl; )
 		*remote_flag = next_buffer_index; // signal remote side that the message has been written, and transfer the next buffer/flag index in the process
 		_mm_sfence(); // NOTE: intel intrinsic: store fence, make changes visible on the remote site
 	}
@@ -485,15 +528,6 @@ public:
 		return recv_msg(ham_host_address, NO_BUFFER_INDEX, msg, size);
 	}
 	
-	// trigger receiving the result of a message on the sending side
-	void recv_result(request_reference_type req)
-	{
-		HAM_UNUSED_VAR(req);
-		// nothing to do here, since this communicator implementation uses one-sided communication
-		// the data is already where it is expected (in the buffer referenced in req)
-		return;
-	}
-
 
 	template<typename T>
 	void send_data(T* local_source, buffer_ptr<T>& remote_dest, size_t size)
@@ -564,6 +598,7 @@ private:
 		{}
 
 		request next_request; // the next request, belonging to next flag
+		std::mutex send_mutex; // held from allocate_request() until commit_msg()
 		size_t next_flag; // flag
 
 		// VEO data
@@ -21,6 +21,7 @@
 
 // offload
 #include "ham/offload/offload.hpp"
+#include "ham/offload/arena.hpp"
 
 // runtime
 #ifdef HAM_EXPLICIT
@@ -0,0 +1,117 @@
+// Copyright (c) 2013-2026 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ham_offload_arena_hpp
+#define ham_offload_arena_hpp
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+#include "ham/misc/constants.hpp"
+#include "ham/misc/types.hpp"
+#include "ham/offload/offload.hpp"
+#include "ham/util/debug.hpp"
+#include "ham/util/log.hpp"
+
+namespace ham {
+namespace offload {
+
+// remote sub-allocator: reserves a region of capacity bytes on node once, and hands out sub-buffers of it without any messages,
+// sub-buffers are rounded up to size classes (powers of two, starting at constants::ARENA_MIN_BLOCK), freed blocks are reused
+// by the next allocation of the same size class, reset() releases all sub-buffers at once, the destructor frees the region
+// allocate() returns an invalid buffer_ptr (nullptr), if the region is exhausted
+// NOTE: sub-buffers are aligned to constants::ARENA_MIN_BLOCK relative to the region, which is cache line aligned
+// NOTE: an arena is not thread-safe, like offload::batch
+class arena
+{
+public:
+	arena(node_t node, size_t capacity)
+	 : region(offload::allocate<char>(node, capacity)), capacity_(capacity)
+	{}
+
+	arena(const arena&) = delete;
+	arena& operator=(const arena&) = delete;
+
+	~arena()
+	{
+		offload::free(region);
+	}
+
+	template<typename T>
+	buffer_ptr<T> allocate(size_t n)
+	{
+		if (n > capacity_ / sizeof(T)) { // NOTE: checked first, so that neither n * sizeof(T) nor the size class can overflow
+			HAM_DEBUG( HAM_LOG << "arena::allocate(): " << n << " elements of " << sizeof(T) << " B exceed the capacity on node " << node() << std::endl; )
+			return buffer_ptr<T>(nullptr, node());
+		}
+
+		const size_t size_class = size_class_of(n * sizeof(T));
+		size_t offset;
+		if (size_class < free_blocks.size() && !free_blocks[size_class].empty()) { // reuse a freed block
+			offset = free_blocks[size_class].back();
+			free_blocks[size_class].pop_back();
+		} else if (block_size(size_class) <= capacity_ - top) { // take a new block from the top of the region
+			offset = top;
+			top += block_size(size_class);
+		} else {
+			HAM_DEBUG( HAM_LOG << "arena::allocate(): out of memory for " << (n * sizeof(T)) << " B on node " << node() << std::endl; )
+			return buffer_ptr<T>(nullptr, node());
+		}
+
+		allocated[offset] = size_class;
+		used_ += block_size(size_class);
+		return buffer_ptr<T>(reinterpret_cast<T*>(region.get() + offset), node());
+	}
+
+	// returns the block of ptr to its size class
+	template<typename T>
+	void free(buffer_ptr<T> ptr)
+	{
+		auto it = allocated.find(static_cast<size_t>(reinterpret_cast<char*>(ptr.get()) - region.get()));
+		assert(ptr.node() == node() && it != allocated.end()); // not allocated by this arena, or double free
+		if (it->second >= free_blocks.size())
+			free_blocks.resize(it->second + 1);
+		free_blocks[it->second].push_back(it->first);
+		used_ -= block_size(it->second);
+		allocated.erase(it);
+	}
+
+	// releases all sub-buffers at once
+	void reset()
+	{
+		allocated.clear();
+		free_blocks.clear();
+		top = 0;
+		used_ = 0;
+	}
+
+	node_t node() const { return region.node(); }
+	size_t capacity() const { return capacity_; }
+	size_t used() const { return used_; } // in bytes, including the rounding to size classes
+
+private:
+	static size_t block_size(size_t size_class) { return static_cast<size_t>(constants::ARENA_MIN_BLOCK) << size_class; }
+
+	static size_t size_class_of(size_t size)
+	{
+		size_t size_class = 0;
+		while (block_size(size_class) < size)
+			++size_class;
+		return size_class;
+	}
+
+	buffer_ptr<char> region;
+	const size_t capacity_;
+	size_t top = 0; // offset of the unused rest of the region
+	size_t used_ = 0;
+	std::vector<std::vector<size_t>> free_blocks; // offsets of freed blocks per size class
+	std::unordered_map<size_t, size_t> allocated; // offset -> size class
+};
+
+} // namespace offload
+} // namespace ham
+
+#endif // ham_offload_arena_hpp
@@ -0,0 +1,91 @@
+// Copyright (c) 2013-2026 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ham_offload_continuations_hpp
+#define ham_offload_continuations_hpp
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ham {
+namespace offload {
+namespace detail {
+
+// NOTE: continuations, i.e. future::then(), when_all(), when_any()
+//       every continuation is a small state machine, that is advanced by step() without blocking, e.g. by testing its input futures,
+//       all of them are advanced by progress(), which is called by the host thread(s) whenever they wait for a continuation,
+//       so multiple chains of dependent offloads make progress while the host waits for any of them
+
+class continuation {
+public:
+	virtual ~continuation() = default;
+
+	bool done() const { return done_.load(std::memory_order_acquire); }
+
+	// advances this continuation, unless another thread is doing so, returns done()
+	bool try_step()
+	{
+		if (done())
+			return true;
+		if (busy.exchange(true, std::memory_order_acquire))
+			return false;
+		if (step())
+			done_.store(true, std::memory_order_release);
+		busy.store(false, std::memory_order_release);
+		return done();
+	}
+
+protected:
+	continuation() = default;
+	continuation(const continuation&) = delete;
+	continuation& operator=(const continuation&) = delete;
+
+	// advances the state machine without blocking, returns true when the result is available
+	virtual bool step() = 0;
+
+private:
+	std::atomic<bool> busy { false };
+	std::atomic<bool> done_ { false };
+};
+
+class continuations {
+public:
+	void push(std::shared_ptr<continuation> c)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		active.push_back(std::move(c));
+	}
+
+	// advances all continuations once, returns the number of the ones, that are not done
+	// NOTE: step() may create new continuations, so it is called without holding the lock
+	size_t progress()
+	{
+		std::vector<std::shared_ptr<continuation>> snapshot;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			snapshot = active;
+		}
+
+		for (auto& c : snapshot)
+			c->try_step();
+
+		std::lock_guard<std::mutex> lock(mutex);
+		active.erase(std::remove_if(active.begin(), active.end(), [](const std::shared_ptr<continuation>& c) { return c->done(); }), active.end());
+		return active.size();
+	}
+
+private:
+	std::mutex mutex;
+	std::vector<std::shared_ptr<continuation>> active;
+};
+
+} // namespace detail
+} // namespace offload
+} // namespace ham
+
+#endif // ham_offload_continuations_hpp
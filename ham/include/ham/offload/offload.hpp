@@ -8,8 +8,21 @@
 
 #include "ham/net/communicator.hpp" // must be first for Intel MPI
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <cstring> // memcpy
 #include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "ham/functor/buffer.hpp"
 #include "ham/misc/types.hpp"
@@ -18,6 +31,7 @@
 #include "ham/util/at_end_of_scope_do.hpp"
 #include "ham/util/debug.hpp"
 #include "ham/util/log.hpp"
+#include "ham/util/make_index_sequence.hpp"
 
 namespace ham {
 namespace offload {
@@ -34,7 +48,116 @@ bool is_host(node_t node);
 const node_descriptor& get_node_description(node_t node);
 
 template<typename T>
-class future
+class future;
+
+// advances all continuations (future::then(), when_all(), when_any()) without blocking,
+// returns the number of continuations, that are not done yet
+inline size_t progress()
+{
+	return runtime::instance().continuations().progress();
+}
+
+namespace detail {
+
+// the result of a continuation, until it is taken by future::get()
+template<typename T>
+class deferred_result : public continuation
+{
+public:
+	T take() { return T(std::move(*value)); }
+
+protected:
+	template<typename F>
+	void assign(F f) { value.reset(new T(f())); }
+
+private:
+	std::unique_ptr<T> value;
+};
+
+template<>
+class deferred_result<void> : public continuation
+{
+public:
+	void take() { }
+
+protected:
+	template<typename F>
+	void assign(F f) { f(); }
+};
+
+template<typename T>
+struct is_future : std::false_type { };
+
+template<typename T>
+struct is_future<future<T>> : std::true_type { };
+
+template<typename T>
+struct unwrap_future { using type = T; };
+
+template<typename T>
+struct unwrap_future<future<T>> { using type = T; };
+
+// the return type of a continuation function F, that is called with the result of a future<T>
+template<typename T, typename F>
+struct then_call_result { using type = typename std::result_of<F&(T)>::type; };
+
+template<typename F>
+struct then_call_result<void, F> { using type = typename std::result_of<F&()>::type; };
+
+// the result type of future<T>::then(F), a returned future is unwrapped
+template<typename T, typename F>
+struct then_result { using type = typename unwrap_future<typename then_call_result<T, F>::type>::type; };
+
+
+// the calls collected by an offload::batch, shared with their futures,
+// the batch is sent as a single offload_batch_msg, and its result frame is fetched once for all the futures
+class batch_state : public pending_future
+{
+public:
+	explicit batch_state(node_t node);
+	~batch_state();
+
+	batch_state(const batch_state&) = delete;
+	batch_state& operator=(const batch_state&) = delete;
+
+	// appends a call to the frame and returns true, if it fits and the batch was not sent yet,
+	// func is not touched otherwise
+	template<typename Functor>
+	bool try_add(Functor&& func, size_t& result_offset);
+
+	void send(); // sends the batch, if it was not sent yet
+	bool test();
+	char* results(); // waits for the result frame
+
+	node_t node() const { return node_; }
+	size_t count() const { return count_; }
+	std::chrono::steady_clock::time_point first_call() const { return first_call_; }
+
+	// the maximum sizes of the frame and the result frame, limited by the message buffer size
+	static size_t frame_capacity();
+	static size_t result_capacity();
+
+private:
+	void send_locked();
+	void fetch_results();
+	static void fetch(pending_future* p);
+
+	std::mutex mutex; // NOTE: the futures of a batch may be used by other threads than the batch
+	node_t node_;
+	std::vector<char> frame;
+	size_t count_ = 0;
+	size_t result_size = 0;
+	std::chrono::steady_clock::time_point first_call_;
+	bool sent = false;
+	bool done = false;
+	net::communicator::request req;
+	std::vector<char> results_; // fetched from the message buffer of req
+};
+
+} // namespace detail
+
+template<typename T>
+class future : public detail::pending_future
 {
 public:
 	future() = default;
@@ -49,12 +172,23 @@ public:
 	 : req(req), valid_(true)
 	{}
 
+	// a call inside a batch, its result is at result_offset inside the result frame of the batch
+	future(std::shared_ptr<detail::batch_state> batch, size_t result_offset)
+	 : valid_(true), batch(std::move(batch)), batch_result_offset(result_offset)
+	{}
+
+	// the result of a continuation
+	future(std::shared_ptr<detail::deferred_result<T>> deferred)
+	 : valid_(true), deferred(std::move(deferred))
+	{}
+
 	// move-only object
 	future(const future& other) = delete;
 	
 	future(future&& other)
-	 : req(std::move(other.req)), valid_(other.valid_) // move state of other
+	 : valid_(other.valid_) // move state of other
 	{
+		take_over(other);
 		// invalidate other without deleting anything
 		other.valid_ = false;
 	}
@@ -64,11 +198,12 @@ public:
 	future& operator=(future&& other)
 	{
 		// if this future is valid, we have to complete protocol before overwriting this with other
-		if(valid()) get();
+		if (batch) invalidate(); // the batch completes the protocol, see detail::batch_state
+		else if(valid()) get();
 
 		// move state of other
-		req = std::move(other.req);
 		valid_ = other.valid_;
+		take_over(other);
 		// invalidate other without deleting anything
 		other.valid_ = false;
 		return *this;
@@ -76,13 +211,18 @@ public:
 
 	~future()
 	{
-		if(valid()) get(); // finish the protocol
+		if (batch) invalidate(); // the batch completes the protocol, without sending it early
+		else if(valid()) get(); // finish the protocol
 	}
 
 	// NOTE: not C++11 future conform
 	bool test()
 	{
-		return req.test();
+		if (deferred)
+			return deferred->try_step();
+		if (batch)
+			return batch->test();
+		return runtime::instance().pending_futures().test(*this, [this]() { return !req.valid() || req.test(); });
 	}
 
 	T get()
@@ -90,7 +230,17 @@ public:
 		if (valid()) {
 			auto x = util::at_end_of_scope_do(std::bind(&future<T>::invalidate, this)); // call invalidate() after returning the result by value
 			HAM_DEBUG( HAM_LOG << "future::get(): returning result." << std::endl; )
-			if (req.valid())
+			if (deferred) { // the result of a continuation
+				while (!deferred->try_step()) {
+					runtime::instance().continuations().progress(); // meanwhile, advance all other continuations
+					std::this_thread::yield();
+				}
+				return deferred->take();
+			} else if (batch) // the result is inside the result frame of the batch
+				return reinterpret_cast<detail::result_container<T>*>(batch->results() + batch_result_offset)->get();
+			else if (runtime::instance().pending_futures().complete(*this)) // the result was fetched in advance
+				return fetched_result()->get();
+			else if (req.valid())
 				return static_cast<detail::result_container<T>*>(req.get())->get();
 			else // dummy behaviour
 				return T(); // return default instance
@@ -110,56 +260,470 @@ public:
 		return valid_;// && req.valid();
 	}
 
+	// attaches a continuation, that calls func with the result of this future (without argument for void), once it is available,
+	// func may offload further calls, and return their future, which is unwrapped,
+	// returns a future of the result of func, this future becomes invalid
+	// NOTE: func is called by the thread that advances the continuation without blocking, see offload::progress(),
+	//       e.g. while waiting for any continuation in get()
+	template<typename F>
+	future<typename detail::then_result<T, typename std::decay<F>::type>::type> then(F&& func);
+
 	net::communicator::request_reference_type get_request()
 	{
 		return req;
 	}
 
+	// to be called after the message belonging to the request was sent,
+	// from then on, the result may be fetched in advance when the credits to the target run out
+	void set_pending()
+	{
+		if (req.valid())
+			runtime::instance().pending_futures().push(*this, req.target_node, &future<T>::fetch);
+	}
+
 private:
 	void invalidate()
 	{
 		valid_ = false;
 		if (req.valid())
 			net::communicator::instance().free_request(req);
+		batch.reset();
+		deferred.reset();
+	}
+
+	// NOTE: other's request must only be accessed after a concurrent fetch finished
+	void take_over(future& other)
+	{
+		if (runtime::instance().pending_futures().take_over(*this, other))
+			memcpy(&fetched_result_storage, &other.fetched_result_storage, sizeof fetched_result_storage);
+		req = std::move(other.req);
+		batch = std::move(other.batch);
+		batch_result_offset = other.batch_result_offset;
+		deferred = std::move(other.deferred);
+	}
+
+	// called by pending_futures, when the credits to the target run out
+	static void fetch(detail::pending_future* p)
+	{
+		future<T>& f = *static_cast<future<T>*>(p);
+		// NOTE: results are transferred as byte sequences, so they can be copied the same way
+		memcpy(&f.fetched_result_storage, f.req.get(), sizeof(detail::result_container<T>));
+		net::communicator::instance().free_request(f.req);
+	}
+
+	detail::result_container<T>* fetched_result()
+	{
+		return reinterpret_cast<detail::result_container<T>*>(&fetched_result_storage);
 	}
 
 	net::communicator::request req;
 	bool valid_ = false;
+	std::shared_ptr<detail::batch_state> batch; // only set for calls inside a batch, which have no request of their own
+	size_t batch_result_offset = 0;
+	std::shared_ptr<detail::deferred_result<T>> deferred; // only set for the result of a continuation
+	typename std::aligned_storage<sizeof(detail::result_container<T>), alignof(detail::result_container<T>)>::type fetched_result_storage; // result fetched in advance
+};
+
+// the result of when_any(): the futures, and the index of one that is ready
+template<typename Sequence>
+struct when_any_result {
+	size_t index;
+	Sequence futures;
+};
+
+namespace detail {
+
+// calls func with the result of pred (void: without argument)
+template<typename T>
+struct then_invoke {
+	template<typename F>
+	static typename then_call_result<T, F>::type call(F& func, future<T>& pred) { return func(pred.get()); }
+};
+
+template<>
+struct then_invoke<void> {
+	template<typename F>
+	static typename then_call_result<void, F>::type call(F& func, future<void>& pred) { pred.get(); return func(); }
 };
 
-/*
-// TODO(improvement, maybe): generalise message transfer used by put, get, copy, sync, async
-// internal
-template<typename Result, typename Msg>
-static future<Result> send_msg_async(net::communicator& comm, Msg& msg)
+template<typename T, typename F, typename Call = typename then_call_result<T, F>::type, bool Unwrap = is_future<Call>::value>
+class then_continuation : public deferred_result<Call>
 {
-	// allocate a request and construct a future
-	future<Result> result(comm.allocate_request(remote_dest.node()));
-	comm.send_msg(result.get_request(), static_cast<void*>(&msg), sizeof msg);
-	comm.recv_result(result.get_request()); // trigger receiving the result message (async)
-	return result; // synchronise
+public:
+	then_continuation(future<T>&& pred, F&& func) : pred(std::move(pred)), func(std::move(func)) { }
+
+protected:
+	bool step() override
+	{
+		if (!pred.test())
+			return false;
+		this->assign([this]() { return then_invoke<T>::call(func, pred); });
+		return true;
+	}
+
+private:
+	future<T> pred;
+	F func;
+};
+
+// func returned a future, which is waited for as well
+template<typename T, typename F, typename Call>
+class then_continuation<T, F, Call, true> : public deferred_result<typename unwrap_future<Call>::type>
+{
+public:
+	then_continuation(future<T>&& pred, F&& func) : pred(std::move(pred)), func(std::move(func)) { }
+
+protected:
+	bool step() override
+	{
+		if (!called) {
+			if (!pred.test())
+				return false;
+			inner = then_invoke<T>::call(func, pred);
+			called = true;
+		}
+		if (!inner.test())
+			return false;
+		this->assign([this]() { return inner.get(); });
+		return true;
+	}
+
+private:
+	future<T> pred;
+	F func;
+	bool called = false;
+	Call inner;
+};
+
+template<typename... Ts>
+class when_all_continuation : public deferred_result<std::tuple<future<Ts>...>>
+{
+public:
+	when_all_continuation(future<Ts>&&... futures) : futures(std::move(futures)...) { }
+
+protected:
+	bool step() override
+	{
+		if (!all_ready(typename util::make_index_sequence<sizeof...(Ts)>::type()))
+			return false;
+		this->assign([this]() { return std::move(futures); });
+		return true;
+	}
+
+private:
+	template<size_t... I>
+	bool all_ready(util::index_sequence<I...>)
+	{
+		const bool ready[] = { true, std::get<I>(futures).test()... };
+		return std::find(std::begin(ready), std::end(ready), false) == std::end(ready);
+	}
+
+	std::tuple<future<Ts>...> futures;
+};
+
+template<typename T>
+class when_all_vector_continuation : public deferred_result<std::vector<future<T>>>
+{
+public:
+	when_all_vector_continuation(std::vector<future<T>>&& futures) : futures(std::move(futures)) { }
+
+protected:
+	bool step() override
+	{
+		for (; ready < futures.size(); ++ready) // NOTE: the futures before ready are known to be ready
+			if (!futures[ready].test())
+				return false;
+		this->assign([this]() { return std::move(futures); });
+		return true;
+	}
+
+private:
+	std::vector<future<T>> futures;
+	size_t ready = 0;
+};
+
+template<typename... Ts>
+class when_any_continuation : public deferred_result<when_any_result<std::tuple<future<Ts>...>>>
+{
+public:
+	when_any_continuation(future<Ts>&&... futures) : futures(std::move(futures)...) { }
+
+protected:
+	bool step() override
+	{
+		const size_t index = first_ready(typename util::make_index_sequence<sizeof...(Ts)>::type());
+		if (index == sizeof...(Ts))
+			return false;
+		this->assign([this, index]() { return when_any_result<std::tuple<future<Ts>...>>{ index, std::move(futures) }; });
+		return true;
+	}
+
+private:
+	// returns sizeof...(Ts) if none is ready
+	template<size_t... I>
+	size_t first_ready(util::index_sequence<I...>)
+	{
+		const bool ready[] = { std::get<I>(futures).test()..., true };
+		return std::find(std::begin(ready), std::end(ready), true) - std::begin(ready);
+	}
+
+	std::tuple<future<Ts>...> futures;
+};
+
+template<typename T>
+class when_any_vector_continuation : public deferred_result<when_any_result<std::vector<future<T>>>>
+{
+public:
+	when_any_vector_continuation(std::vector<future<T>>&& futures) : futures(std::move(futures)) { }
+
+protected:
+	bool step() override
+	{
+		size_t index = 0;
+		while (index < futures.size() && !futures[index].test())
+			++index;
+		if (index == futures.size() && !futures.empty())
+			return false;
+		this->assign([this, index]() { return when_any_result<std::vector<future<T>>>{ index, std::move(futures) }; });
+		return true;
+	}
+
+private:
+	std::vector<future<T>> futures;
+};
+
+// registers c for progress(), and returns a future of its result
+template<typename Result, typename Continuation>
+future<Result> make_continuation_future(std::shared_ptr<Continuation> c)
+{
+	runtime::instance().continuations().push(c);
+	return future<Result>(std::shared_ptr<deferred_result<Result>>(std::move(c)));
 }
 
-//internal
-template<typename Result, typename Msg>
-static Result send_msg_sync(net::communicator& comm, Msg& msg)
+} // namespace detail
+
+template<typename T>
+template<typename F>
+future<typename detail::then_result<T, typename std::decay<F>::type>::type> future<T>::then(F&& func)
 {
-	return send_msg_async(comm, msg).get();
+	using FunctorT = typename std::decay<F>::type;
+	using Result = typename detail::then_result<T, FunctorT>::type;
+	assert(valid());
+	return detail::make_continuation_future<Result>(std::make_shared<detail::then_continuation<T, FunctorT>>(std::move(*this), FunctorT(std::forward<F>(func))));
 }
-*/
 
-// asynchronous offload
+// returns a future, that becomes ready when all the futures are ready, its result are the futures
+template<typename... Ts>
+future<std::tuple<future<Ts>...>> when_all(future<Ts>&&... futures)
+{
+	return detail::make_continuation_future<std::tuple<future<Ts>...>>(std::make_shared<detail::when_all_continuation<Ts...>>(std::move(futures)...));
+}
+
+template<typename T>
+future<std::vector<future<T>>> when_all(std::vector<future<T>>&& futures)
+{
+	return detail::make_continuation_future<std::vector<future<T>>>(std::make_shared<detail::when_all_vector_continuation<T>>(std::move(futures)));
+}
+
+// returns a future, that becomes ready when any of the futures is ready, its result are the futures, and the index of a ready one
+// NOTE: for an empty vector, the result is ready immediately, with index 0
+template<typename... Ts>
+future<when_any_result<std::tuple<future<Ts>...>>> when_any(future<Ts>&&... futures)
+{
+	static_assert(sizeof...(Ts) > 0, "when_any() requires at least one future.");
+	return detail::make_continuation_future<when_any_result<std::tuple<future<Ts>...>>>(std::make_shared<detail::when_any_continuation<Ts...>>(std::move(futures)...));
+}
+
+template<typename T>
+future<when_any_result<std::vector<future<T>>>> when_any(std::vector<future<T>>&& futures)
+{
+	return detail::make_continuation_future<when_any_result<std::vector<future<T>>>>(std::make_shared<detail::when_any_vector_continuation<T>>(std::move(futures)));
+}
+
+namespace detail {
+
+// completes a detached future, see offload::detach()
+template<typename T>
+class detached_continuation : public continuation
+{
+public:
+	explicit detached_continuation(future<T>&& f) : f(std::move(f)) { }
+
+protected:
+	bool step() override
+	{
+		if (!f.test())
+			return false;
+		f.get();
+		return true;
+	}
+
+private:
+	future<T> f;
+};
+
+} // namespace detail
+
+// fire-and-forget: the future is completed in the background, like a continuation, i.e. by offload::progress(),
+// or while the host waits for any continuation, its result is discarded,
+// all detached futures are completed before the offload targets are terminated
+template<typename T>
+void detach(future<T>&& f)
+{
+	if (f.valid())
+		runtime::instance().continuations().push(std::make_shared<detail::detached_continuation<T>>(std::move(f)));
+}
+
+template<typename T>
+buffer_ptr<T> allocate(const node_t node, size_t n);
+
+template<typename T>
+void free(buffer_ptr<T> remote_data);
+
+// true if async() sends a functor of this type eagerly, i.e. as a single message that fits into a message buffer of the default size,
+// larger functors use the rendezvous protocol: a small message, plus a separate transfer of the functor into a staging buffer on the target
+// NOTE: this is only a compile-time hint for the default size, the path is chosen at runtime for the size set by --ham-msg-size, see detail::is_eager_msg()
 template<typename Functor>
-future<typename std::remove_reference<Functor>::type::result_type> async(node_t node, Functor&& func)
-//auto async(node_t node, Functor&& func) -> typename Functor::result_type
+struct is_eager : std::integral_constant<bool, sizeof(detail::offload_result_msg<typename std::remove_reference<Functor>::type>) <= constants::MSG_SIZE> { };
+
+namespace detail {
+
+// true if async() sends a functor of this type eagerly with the message buffer size of comm (--ham-msg-size)
+template<typename FunctorT>
+bool is_eager_msg(net::communicator& comm)
+{
+	return sizeof(offload_result_msg<FunctorT>) <= comm.max_msg_size();
+}
+
+// the path of async() for a functor type: std::true_type (eager) if it fits into any message buffer size (constants::MIN_MSG_SIZE),
+// so that only the eager path is compiled for it, otherwise runtime_path, i.e. both paths, chosen by is_eager_msg()
+struct runtime_path { };
+
+template<typename FunctorT>
+using offload_path = typename std::conditional<sizeof(offload_result_msg<FunctorT>) <= constants::MIN_MSG_SIZE, std::true_type, runtime_path>::type;
+
+// constructs a message of type Msg in place inside the communication buffer belonging to req and sends it
+// NOTE: this avoids constructing the message on the stack and copying it into the buffer,
+//       the message is never destructed on the sending side, it is transferred as a sequence of bytes
+template<typename Msg, typename... Args>
+void send_msg_inplace(net::communicator& comm, net::communicator::request_reference_type req, Args&&... args)
+{
+	// NOTE: the message buffer size is configured at runtime (--ham-msg-size), so this cannot be a static_assert
+	if (sizeof(Msg) > comm.max_msg_size()) {
+		HAM_LOG << "send_msg_inplace(): error: message of " << sizeof(Msg) << " B exceeds the message buffer size of " << comm.max_msg_size() << " B, please increase --ham-msg-size." << std::endl;
+		exit(EXIT_FAILURE);
+	}
+	void* buffer = comm.reserve_msg_buffer(req);
+	new (buffer) Msg(std::forward<Args>(args)...);
+	comm.commit_msg(req, sizeof(Msg));
+}
+
+// returns a request to node, blocks while all message buffers (credits) to node are in use,
+// meanwhile the oldest pending results to node are fetched into their futures to return credits
+inline net::communicator::request acquire_request(net::communicator& comm, node_t node)
+{
+	net::communicator::request req = comm.try_allocate_request(node);
+	while (!req.valid()) {
+		HAM_DEBUG( HAM_LOG << "acquire_request(): out of credits for node " << node << ", fetching pending results" << std::endl; )
+		if (!runtime::instance().pending_futures().fetch_oldest(node))
+			std::this_thread::yield(); // the credits are held by requests, that are completed by other threads
+		req = comm.try_allocate_request(node);
+	}
+	return req;
+}
+
+// small transfers carry their data inside the message (put()) or the result (get()) on two-sided communicators,
+// instead of a separate data transfer, which halves the number of messages
+template<typename T>
+bool is_inline_write(net::communicator& comm, size_t n)
+{
+	return n * sizeof(T) <= constants::INLINE_TRANSFER_SIZE && offload_write_inline_msg<T>::payload_offset() + n * sizeof(T) <= comm.max_msg_size();
+}
+
+template<typename T>
+bool is_inline_read(net::communicator& comm, size_t n)
+{
+	return n * sizeof(T) <= constants::INLINE_TRANSFER_SIZE && n * sizeof(T) <= comm.max_msg_size();
+}
+
+// 1st step of the rendezvous protocol for one-sided communicators: writes func into a new staging buffer on node,
+// returns an invalid staging buffer (nullptr) if func is sent eagerly or by a two-sided communicator
+// NOTE: must be called before acquiring the request for func, because the allocation needs a request to node itself
+template<typename FunctorT>
+buffer_ptr<char> stage_functor(net::communicator& comm, node_t node, const FunctorT& func, std::false_type /* eager */)
+{
+#ifdef HAM_COMM_ONE_SIDED
+	buffer_ptr<char> staging = allocate<char>(node, sizeof(FunctorT));
+	comm.send_data(reinterpret_cast<char*>(const_cast<FunctorT*>(&func)), staging, sizeof(FunctorT));
+	return staging;
+#else
+	HAM_UNUSED_VAR(comm);
+	HAM_UNUSED_VAR(func);
+	return buffer_ptr<char>(nullptr, node);
+#endif
+}
+
+template<typename FunctorT>
+buffer_ptr<char> stage_functor(net::communicator& comm, node_t node, const FunctorT& func, std::true_type /* eager */)
+{
+	HAM_UNUSED_VAR(comm);
+	HAM_UNUSED_VAR(func);
+	return buffer_ptr<char>(nullptr, node);
+}
+
+template<typename FunctorT>
+buffer_ptr<char> stage_functor(net::communicator& comm, node_t node, const FunctorT& func, runtime_path)
+{
+	if (is_eager_msg<FunctorT>(comm))
+		return stage_functor(comm, node, func, std::true_type());
+	return stage_functor(comm, node, func, std::false_type());
+}
+
+template<typename FunctorT>
+buffer_ptr<char> stage_functor(net::communicator& comm, node_t node, const FunctorT& func)
+{
+	return stage_functor(comm, node, func, offload_path<FunctorT>());
+}
+
+template<typename Functor>
+void send_offload_msg(net::communicator& comm, net::communicator::request_reference_type req, Functor&& func, buffer_ptr<char> staging, std::true_type /* eager */)
+{
+	HAM_UNUSED_VAR(staging);
+	send_msg_inplace<offload_result_msg<typename std::remove_reference<Functor>::type>>(comm, req, std::forward<Functor>(func), req);
+}
+
+template<typename Functor>
+void send_offload_msg(net::communicator& comm, net::communicator::request_reference_type req, Functor&& func, buffer_ptr<char> staging, std::false_type /* eager */)
 {
 	using FunctorT = typename std::remove_reference<Functor>::type;
-	using Result = typename FunctorT::result_type;
+	HAM_DEBUG( HAM_LOG << "runtime::async(): functor of " << sizeof(FunctorT) << " B exceeds the message buffer, using rendezvous" << std::endl; )
+#ifdef HAM_COMM_ONE_SIDED
+	HAM_UNUSED_VAR(func);
+	send_msg_inplace<offload_rendezvous_result_msg<FunctorT>>(comm, req, req, staging, 0);
+#else
+	const int data_tag = comm.data_tag(req);
+	send_msg_inplace<offload_rendezvous_result_msg<FunctorT>>(comm, req, req, staging, data_tag);
+	comm.send_data(reinterpret_cast<char*>(&func), buffer_ptr<char>(nullptr, staging.node()), sizeof(FunctorT), data_tag); // NOTE: blocks until the target received the functor
+#endif
+}
 
-	net::communicator& comm = runtime::instance().communicator();
+template<typename Functor>
+void send_offload_msg(net::communicator& comm, net::communicator::request_reference_type req, Functor&& func, buffer_ptr<char> staging, runtime_path)
+{
+	if (is_eager_msg<typename std::remove_reference<Functor>::type>(comm))
+		send_offload_msg(comm, req, std::forward<Functor>(func), staging, std::true_type());
+	else
+		send_offload_msg(comm, req, std::forward<Functor>(func), staging, std::false_type());
+}
 
-	// allocate a request and construct a future
-	future<Result> result(comm.allocate_request(node));
+template<typename Functor>
+future<typename std::remove_reference<Functor>::type::result_type> async(net::communicator& comm, net::communicator::request req, Functor&& func, buffer_ptr<char> staging)
+{
+	using FunctorT = typename std::remove_reference<Functor>::type;
+	using Result = typename FunctorT::result_type;
+
+	// construct a future, that owns req
+	future<Result> result(req);
 
 //	{
 //		HAM_DEBUG(
@@ -167,16 +731,51 @@ future<typename std::remove_reference<Functor>::type::result_type> async(node_t
 //				HAM_LOG << "runtime::async(): req(" << req.target_node << ", " << req.target_buffer_index << ", " << req.source_node << ", " << req.source_buffer_index << ")" << std::endl; )
 //	}
 
-	// generate an offload message
-	// TODO(improvement, high priority): create message inplace the communication buffer and avoid a copy
-	auto msg = detail::offload_result_msg<FunctorT>(std::forward<Functor>(func), result.get_request());
+	// generate an offload message inside the communication buffer
 	HAM_DEBUG( HAM_LOG << "runtime::async(): sending msg..." << std::endl; )
-	comm.send_msg(result.get_request(), (void*)&msg, sizeof msg);
-	comm.recv_result(result.get_request()); // trigger receiving the result
+	send_offload_msg(comm, result.get_request(), std::forward<Functor>(func), staging, offload_path<FunctorT>());
+	comm.recv_result(result.get_request(), sizeof(detail::result_container<Result>)); // trigger receiving the result
+	result.set_pending();
 
 	return result;
 }
 
+} // namespace detail
+
+// asynchronous offload
+// NOTE: blocks while all message buffers to node are in use, see detail::acquire_request()
+// NOTE: with HAM_COMM_PEER_OFFLOAD, offloaded functors can offload to other targets (not to the host), but waiting for
+//       the result blocks the receiving thread of the calling target, unless it is a worker, see --ham-target-threads
+template<typename Functor>
+future<typename std::remove_reference<Functor>::type::result_type> async(node_t node, Functor&& func)
+//auto async(node_t node, Functor&& func) -> typename Functor::result_type
+{
+	net::communicator& comm = runtime::instance().communicator();
+	buffer_ptr<char> staging = detail::stage_functor(comm, node, func);
+	return detail::async(comm, detail::acquire_request(comm, node), std::forward<Functor>(func), staging);
+}
+
+// asynchronous offload, that never blocks on back-pressure
+// returns an invalid future, i.e. valid() == false, without sending anything, if all message buffers to node are in use
+template<typename Functor>
+future<typename std::remove_reference<Functor>::type::result_type> try_async(node_t node, Functor&& func)
+{
+	using Result = typename std::remove_reference<Functor>::type::result_type;
+
+	net::communicator& comm = runtime::instance().communicator();
+	buffer_ptr<char> staging = detail::stage_functor(comm, node, func);
+	net::communicator::request req = comm.try_allocate_request(node);
+	if (!req.valid() && runtime::instance().pending_futures().reclaim_pings(node) > 0) // finished pings still held credits
+		req = comm.try_allocate_request(node);
+	if (!req.valid()) {
+		// NOTE: this may block, but only for functors that take the rendezvous path with one-sided communicators
+		if (staging.get() != nullptr)
+			offload::free(staging);
+		return future<Result>(false);
+	}
+	return detail::async(comm, req, std::forward<Functor>(func), staging);
+}
+
 template<typename Functor>
 typename std::remove_reference<Functor>::type::result_type sync(node_t node, Functor&& func)
 //auto sync(node_t node, Functor&& func) -> typename Functor::result_type
@@ -185,33 +784,226 @@ typename std::remove_reference<Functor>::type::result_type sync(node_t node, Fun
 	return async(node, func).get(); // TODO(investigate): std::forward(func) => compile time error ?!
 }
 
-// synchronously send fire & forget
+// fire & forget, the result is discarded
+// NOTE: the target still acknowledges the call, which returns its message buffer (credit), either when the next ping to node
+//       finds the acknowledgement, or when a later call to node runs out of credits, see detail::pending_futures::push_ping()
 template<typename Functor>
 void ping(node_t node, Functor&& func)
 {
-	using FunctorT = typename std::remove_reference<Functor>::type;
+	using FunctorT = detail::discard_result<typename std::remove_reference<Functor>::type>;
+
 	net::communicator& comm = runtime::instance().communicator();
-	
-	auto msg = detail::offload_msg<FunctorT, msg::execution_policy_direct>(std::forward<Functor>(func));
+	FunctorT ack_only { typename std::remove_reference<Functor>::type(std::forward<Functor>(func)) };
+	buffer_ptr<char> staging = detail::stage_functor(comm, node, ack_only);
+	net::communicator::request req = detail::acquire_request(comm, node);
+
 	HAM_DEBUG( HAM_LOG << "runtime::ping(): sending msg..." << std::endl; )
-	net::communicator::request req = comm.allocate_request(node); // TODO(improvement): resource deallocation of this request (currently only used for terminating)
-	comm.send_msg(req, (void*)&msg, sizeof msg);
+	detail::send_offload_msg(comm, req, std::move(ack_only), staging, detail::offload_path<FunctorT>());
+	comm.recv_result(req, sizeof(detail::result_container<void>)); // trigger receiving the acknowledgement
+	runtime::instance().pending_futures().push_ping(req);
 	HAM_DEBUG( HAM_LOG << "runtime::ping(): sending msg done." << std::endl; )
 }
 
+namespace detail {
+
+inline batch_state::batch_state(node_t node)
+ : node_(node)
+{
+	frame.reserve(frame_capacity());
+}
+
+inline batch_state::~batch_state()
+{
+	// NOTE: like ~future(), complete the protocol
+	if (count_ > 0 && !done)
+		results();
+}
+
+inline size_t batch_state::frame_capacity()
+{
+	return runtime::instance().communicator().max_msg_size() - batch_align(sizeof(offload_batch_msg));
+}
+
+inline size_t batch_state::result_capacity()
+{
+	return runtime::instance().communicator().max_msg_size();
+}
+
+template<typename Functor>
+bool batch_state::try_add(Functor&& func, size_t& result_offset)
+{
+	using FunctorT = typename std::remove_reference<Functor>::type;
+	using Msg = offload_batch_item_msg<FunctorT>;
+	const size_t item_size = batch_align(BATCH_ITEM_HEADER_SIZE + sizeof(Msg));
+	const size_t item_result_size = batch_align(sizeof(result_container<typename FunctorT::result_type>));
+
+	std::lock_guard<std::mutex> lock(mutex);
+	if (sent || frame.size() + item_size > frame_capacity() || result_size + item_result_size > result_capacity())
+		return false;
+
+	if (count_ == 0)
+		first_call_ = std::chrono::steady_clock::now();
+	result_offset = result_size;
+	const size_t offset = frame.size();
+	frame.resize(offset + item_size);
+	memcpy(&frame[offset], &item_size, sizeof item_size);
+	new (&frame[offset + BATCH_ITEM_HEADER_SIZE]) Msg(std::forward<Functor>(func), result_offset); // NOTE: never destructed, like all messages
+	result_size += item_result_size;
+	++count_;
+	return true;
+}
+
+inline void batch_state::send()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	send_locked();
+}
+
+inline void batch_state::send_locked()
+{
+	if (sent)
+		return;
+	sent = true;
+	if (count_ == 0) {
+		done = true;
+		return;
+	}
+
+	net::communicator& comm = runtime::instance().communicator();
+	req = acquire_request(comm, node_);
+	HAM_DEBUG( HAM_LOG << "batch_state::send(): sending " << count_ << " calls in a frame of " << frame.size() << " B to node " << node_ << std::endl; )
+	// NOTE: like send_msg_inplace(), but the frame follows the message inside the message buffer
+	const size_t frame_offset = batch_align(sizeof(offload_batch_msg));
+	char* buffer = static_cast<char*>(comm.reserve_msg_buffer(req));
+	new (buffer) offload_batch_msg(req, count_, result_size);
+	memcpy(buffer + frame_offset, frame.data(), frame.size());
+	comm.commit_msg(req, frame_offset + frame.size());
+	comm.recv_result(req, result_size); // trigger receiving the result frame
+	runtime::instance().pending_futures().push(*this, node_, &batch_state::fetch);
+	std::vector<char>().swap(frame); // not needed anymore
+}
+
+inline bool batch_state::test()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (done)
+		return true;
+	send_locked(); // NOTE: otherwise, continuations would wait forever for an unsent batch
+	return runtime::instance().pending_futures().test(*this, [this]() { return req.test(); });
+}
+
+inline char* batch_state::results()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	send_locked();
+	if (!done) {
+		if (!runtime::instance().pending_futures().complete(*this)) // not fetched in advance
+			fetch_results();
+		done = true;
+	}
+	return results_.data();
+}
+
+inline void batch_state::fetch_results()
+{
+	const char* result_frame = static_cast<const char*>(req.get());
+	results_.assign(result_frame, result_frame + result_size);
+	runtime::instance().communicator().free_request(req);
+}
+
+// called by pending_futures, when the credits to the node run out
+inline void batch_state::fetch(pending_future* p)
+{
+	static_cast<batch_state*>(p)->fetch_results();
+}
+
+} // namespace detail
+
+// message aggregation: collects calls to one node, and sends them as a single message,
+// the target executes them in order, and sends back all their results as a single message,
+// async() returns an ordinary future per call, resolved from the common result
+// a batch is sent by flush(), when the next call does not fit into the message buffer, after max_calls calls (if non-zero),
+// when max_delay (if non-zero) elapsed since its first call (checked on each call), on destruction,
+// and when a future of it is waited for by get() or test()
+// NOTE: a batch itself is not thread-safe, but its futures can be passed to other threads like any future
+class batch
+{
+public:
+	explicit batch(node_t node, size_t max_calls = 0, std::chrono::microseconds max_delay = std::chrono::microseconds::zero())
+	 : node_(node), max_calls(max_calls), max_delay(max_delay), state(std::make_shared<detail::batch_state>(node))
+	{}
+
+	batch(const batch&) = delete;
+	batch& operator=(const batch&) = delete;
+
+	~batch()
+	{
+		flush();
+	}
+
+	template<typename Functor>
+	future<typename std::remove_reference<Functor>::type::result_type> async(Functor&& func)
+	{
+		using Result = typename std::remove_reference<Functor>::type::result_type;
+
+		size_t result_offset = 0;
+		if (!state->try_add(std::forward<Functor>(func), result_offset)) { // NOTE: func is not touched on failure
+			flush();
+			if (!state->try_add(std::forward<Functor>(func), result_offset)) // does not even fit into an empty batch
+				return offload::async(node_, std::forward<Functor>(func));
+		}
+		future<Result> result(state, result_offset);
+
+		if ((max_calls > 0 && state->count() >= max_calls)
+			|| (max_delay > std::chrono::microseconds::zero() && std::chrono::steady_clock::now() - state->first_call() >= max_delay))
+			flush();
+
+		return result;
+	}
+
+	// sends the collected calls, if any
+	void flush()
+	{
+		if (state->count() == 0)
+			return;
+		state->send();
+		state = std::make_shared<detail::batch_state>(node_);
+	}
+
+	node_t node() const { return node_; }
+	size_t size() const { return state->count(); } // number of calls since the last flush
+
+private:
+	node_t node_;
+	size_t max_calls;
+	std::chrono::microseconds max_delay;
+	std::shared_ptr<detail::batch_state> state; // the calls, that were not sent yet
+};
+
+
+template<typename T>
+future<buffer_ptr<T>> allocate_async(const node_t node, size_t n)
+{
+	return async(node, new_buffer<T>(n, this_node()));
+}
 
 template<typename T>
 buffer_ptr<T> allocate(const node_t node, size_t n)
 {
-	// use existing functor + sync
-	return sync(node, new_buffer<T>(n, this_node()));
+	return allocate_async<T>(node, n).get();
+}
+
+// NOTE: use offload::detach() on the result for a fire-and-forget free
+template<typename T>
+future<void> free_async(buffer_ptr<T> remote_data)
+{
+	return async(remote_data.node(), delete_buffer<T>(remote_data));
 }
 
 template<typename T>
 void free(buffer_ptr<T> remote_data)
 {
-	sync(remote_data.node(), delete_buffer<T>(remote_data));
-	// use existing functor + sync
+	free_async(remote_data).get();
 }
 
 template<typename T>
@@ -224,13 +1016,25 @@ future<void> put(T* local_source, buffer_ptr<T>& remote_dest, size_t n)
 	return future<void>(true); // return dummy future
 #else
 	// allocate a request and construct a future
-	future<void> result(comm.allocate_request(remote_dest.node()));
-	// generate an offload message
-	auto msg = detail::offload_write_msg<T>(result.get_request(), this_node(), remote_dest.get(), n);
+	future<void> result(detail::acquire_request(comm, remote_dest.node()));
+	if (detail::is_inline_write<T>(comm, n)) {
+		HAM_DEBUG( HAM_LOG << "runtime::write(): sending inline write msg..." << std::endl; )
+		using Msg = detail::offload_write_inline_msg<T>;
+		// NOTE: like send_msg_inplace(), but the data follows the message inside the message buffer
+		char* buffer = static_cast<char*>(comm.reserve_msg_buffer(result.get_request()));
+		new (buffer) Msg(result.get_request(), remote_dest.get(), n);
+		memcpy(buffer + Msg::payload_offset(), (void*)local_source, n * sizeof(T));
+		comm.commit_msg(result.get_request(), Msg::payload_offset() + n * sizeof(T));
+		comm.recv_result(result.get_request(), Msg::result_size); // trigger receiving the msgs result // async
+		result.set_pending();
+		return result;
+	}
+	// generate an offload message inside the communication buffer
 	HAM_DEBUG( HAM_LOG << "runtime::write(): sending write msg..." << std::endl; )
-	comm.send_msg(result.get_request(), (void*)&msg, sizeof msg); // async
+	detail::send_msg_inplace<detail::offload_write_msg<T>>(comm, result.get_request(), result.get_request(), this_node(), remote_dest.get(), n, comm.data_tag(result.get_request())); // async
 	comm.send_data_async(result.get_request(), local_source, remote_dest, n); // async
-	comm.recv_result(result.get_request()); // trigger receiving the msgs result // async
+	comm.recv_result(result.get_request(), detail::offload_write_msg<T>::result_size); // trigger receiving the msgs result // async
+	result.set_pending();
 	
 	return result;
 #endif
@@ -257,13 +1061,20 @@ future<void> get(buffer_ptr<T> remote_source, T* local_dest, size_t n)
 	return future<void>(true); // return dummy future
 #else
 	// allocate a request and construct a future
-	future<void> result(comm.allocate_request(remote_source.node()));
-	// generate an offload message
-	auto msg = detail::offload_read_msg<T>(result.get_request(), this_node(), remote_source.get(), n);
+	future<void> result(detail::acquire_request(comm, remote_source.node()));
+	if (detail::is_inline_read<T>(comm, n)) {
+		HAM_DEBUG( HAM_LOG << "runtime::read(): sending inline read msg..." << std::endl; )
+		detail::send_msg_inplace<detail::offload_read_inline_msg<T>>(comm, result.get_request(), result.get_request(), remote_source.get(), n);
+		comm.recv_result(result.get_request(), (void*)local_dest, n * sizeof(T)); // trigger receiving the data as result
+		result.set_pending();
+		return result;
+	}
+	// generate an offload message inside the communication buffer
 	HAM_DEBUG( HAM_LOG << "runtime::read(): sending read msg..." << std::endl; )
-	comm.send_msg(result.get_request(), (void*)&msg, sizeof msg);
+	detail::send_msg_inplace<detail::offload_read_msg<T>>(comm, result.get_request(), result.get_request(), this_node(), remote_source.get(), n, comm.data_tag(result.get_request()));
 	comm.recv_data_async(result.get_request(), remote_source, local_dest, n);
-	comm.recv_result(result.get_request()); // trigger receiving the result
+	comm.recv_result(result.get_request(), detail::offload_read_msg<T>::result_size); // trigger receiving the result
+	result.set_pending();
 
 	return result;
 #endif
@@ -280,55 +1091,179 @@ void get_sync(buffer_ptr<T> remote_source, T* local_dest, size_t n)
 #endif
 }
 
-// TODO(improvement):
-// generalise copy for the local cases and simplifiy put/get
-// * -> * = copy
-// remote -> remote = copy
+// asynchronous copy of n elements from source to dest, which may be on any nodes,
+// the returned future covers the whole transfer
+// * local -> local = memcpy
 // local -> remote = put
 // remote -> local = get
-// local -> local = (just make a memcpy)
-
-// TODO(feature, high priority): copy_async 
-//	- problems: combine two futures into a new one: recursive list template
-//     sync on read_result and write_result,
-//   
-//template<typename T>
-//future<void> copy(buffer_ptr<T> source, buffer_ptr<T> dest, size_t n)
-//{
-
-//}
-
-#ifndef HAM_COMM_ONE_SIDED // TODO(feature, high priority): implement
+// remote -> remote = transfer between the two nodes, without host memory (if supported by the communicator, see HAM_COMM_TARGET_TRANSFERS)
+// NOTE: on one-sided communicators, put() and get() transfer synchronously, so do the transfers of copy_async() that involve host memory,
+//       including remote -> remote without HAM_COMM_TARGET_TRANSFERS, which is staged through host memory (e.g. SCIF, VEO),
+//       in these cases, the returned future is already complete
 template<typename T>
-void copy_sync(buffer_ptr<T> source, buffer_ptr<T> dest, size_t n)
+future<void> copy_async(buffer_ptr<T> source, buffer_ptr<T> dest, size_t n)
 {
-	net::communicator& comm = runtime::instance().communicator();
-#ifdef HAM_COMM_ONE_SIDED
-// TODO(feature, high priority): implement
-// fix 1st arg:
-//	comm.send_data(src_node, local_source, remote_dest, n);
-//	static_assert(false, "copy is not implemented yet for the SCIF back-end");
+	if (source.node() == this_node() && dest.node() == this_node()) {
+		memcpy(static_cast<void*>(dest.get()), static_cast<const void*>(source.get()), n * sizeof(T));
+		return future<void>(true); // return dummy future
+	}
+	if (source.node() == this_node())
+		return put(source.get(), dest, n);
+	if (dest.node() == this_node())
+		return get(source, dest.get(), n);
+	if (source.node() == dest.node())
+		return async(dest.node(), copy_buffer<T>(source, dest, n)); // local copy on that node
+
+#if defined HAM_COMM_ONE_SIDED && defined HAM_COMM_TARGET_TRANSFERS
+	// target-initiated: the node of dest reads from the node of source
+	return async(dest.node(), copy_buffer<T>(source, dest, n));
+#elif defined HAM_COMM_ONE_SIDED
+	// NOTE: the targets cannot transfer data between each other, so the data is staged in host memory,
+	//       chaining the futures of get() and put() would not help, as both block on one-sided communicators
+	std::unique_ptr<char[]> staging(new char[n * sizeof(T)]);
+	T* staging_ptr = reinterpret_cast<T*>(staging.get());
+	get_sync(source, staging_ptr, n);
+	put_sync(staging_ptr, dest, n);
+	return future<void>(true); // return dummy future
 #else
-	// send corresponding write and read messages to the sender and the receiver
+	// send corresponding read and write messages to the sender and the receiver
+	net::communicator& comm = runtime::instance().communicator();
 
 	// issues a send operation on the source node, that sends the memory at source to the destination node
-	future<void> read_result(comm.allocate_request(source.node()));
-	auto read_msg = detail::offload_read_msg<T>(read_result.get_request(), dest.node(), source.get(), n); 
-	comm.send_msg(read_result.get_request(), (void*)&read_msg, sizeof read_msg);
-	comm.recv_result(read_result.get_request()); // trigger receiving the result
+	future<void> read_result(detail::acquire_request(comm, source.node()));
+	const int data_tag = comm.data_tag(read_result.get_request()); // NOTE: the transfer between source and dest is tagged like the read
+	detail::send_msg_inplace<detail::offload_read_msg<T>>(comm, read_result.get_request(), read_result.get_request(), dest.node(), source.get(), n, data_tag);
+	comm.recv_result(read_result.get_request(), detail::offload_read_msg<T>::result_size); // trigger receiving the result
+	read_result.set_pending();
 
 	// issues a receive operation on the destination node, that receives from source.node()
-	future<void> write_result(comm.allocate_request(dest.node()));
-	auto write_msg = detail::offload_write_msg<T>(write_result.get_request(), source.node(), dest.get(), n);
-	comm.send_msg(write_result.get_request(), (void*)&write_msg, sizeof write_msg); // async
-	comm.recv_result(write_result.get_request()); // trigger receiving the msg result // async
-	
-	// synchronise
-	read_result.get();
-	write_result.get();
+	future<void> write_result(detail::acquire_request(comm, dest.node()));
+	detail::send_msg_inplace<detail::offload_write_msg<T>>(comm, write_result.get_request(), write_result.get_request(), source.node(), dest.get(), n, data_tag); // async
+	comm.recv_result(write_result.get_request(), detail::offload_write_msg<T>::result_size); // trigger receiving the msg result // async
+	write_result.set_pending();
+
+	// a single future, that is ready when both are
+	return when_all(std::move(read_result), std::move(write_result)).then([](std::tuple<future<void>, future<void>> results) {
+		std::get<0>(results).get();
+		std::get<1>(results).get();
+	});
 #endif
 }
-#endif
+
+template<typename T>
+void copy_sync(buffer_ptr<T> source, buffer_ptr<T> dest, size_t n)
+{
+	copy_async(source, dest, n).get();
+}
+
+namespace detail {
+
+struct no_chunk_callback { };
+
+// a put or get of n elements in chunks of chunk_size elements, with up to window chunks in flight,
+// advanced like any continuation, see future::then()
+template<typename T, typename Callback>
+class chunked_transfer : public deferred_result<void>
+{
+public:
+	chunked_transfer(bool is_put, T* local, buffer_ptr<T> remote, size_t n, size_t chunk_size, size_t window, const Callback& callback)
+	 : is_put(is_put), local(local), remote(remote), n(n), chunk_size(chunk_size), window(window), callback(callback)
+	{
+		assert(chunk_size > 0 && window > 0);
+	}
+
+protected:
+	bool step() override
+	{
+		// complete chunks in order
+		while (!in_flight.empty() && in_flight.front().transfer.test() && in_flight.front().callback.test()) {
+			in_flight.front().transfer.get();
+			if (in_flight.front().callback.valid())
+				in_flight.front().callback.get();
+			in_flight.erase(in_flight.begin());
+		}
+
+		// issue the next chunks
+		while (offset < n && in_flight.size() < window)
+			issue_chunk();
+
+		return offset == n && in_flight.empty();
+	}
+
+private:
+	struct chunk {
+		future<void> transfer;
+		future<void> callback; // invalid without callback
+	};
+
+	void issue_chunk()
+	{
+		const size_t count = std::min(chunk_size, n - offset);
+		buffer_ptr<T> remote_chunk(remote.get() + offset, remote.node());
+		chunk c;
+		c.transfer = is_put ? offload::put(local + offset, remote_chunk, count) : offload::get(remote_chunk, local + offset, count);
+		c.callback = notify(offset, count, callback);
+		in_flight.push_back(std::move(c));
+		offset += count;
+	}
+
+	future<void> notify(size_t, size_t, no_chunk_callback)
+	{
+		return future<void>();
+	}
+
+	// NOTE: messages to a node are executed in order, so the callback runs after the chunk arrived
+	template<typename C>
+	future<void> notify(size_t chunk_offset, size_t count, const C& c)
+	{
+		return offload::async(remote.node(), chunk_callback<T, C>(c, remote, chunk_offset, count));
+	}
+
+	const bool is_put;
+	T* local;
+	buffer_ptr<T> remote;
+	const size_t n;
+	const size_t chunk_size;
+	const size_t window;
+	Callback callback;
+	size_t offset = 0; // of the next chunk to issue
+	std::vector<chunk> in_flight; // oldest first
+};
+
+template<typename T, typename Callback>
+future<void> chunked(bool is_put, T* local, buffer_ptr<T> remote, size_t n, size_t chunk_size, size_t window, const Callback& callback)
+{
+	auto c = std::make_shared<chunked_transfer<T, Callback>>(is_put, local, remote, n, chunk_size, window, callback);
+	c->try_step(); // issue the first chunks right away
+	return make_continuation_future<void>(std::move(c));
+}
+
+} // namespace detail
+
+// chunked, pipelined transfers for large buffers:
+// n elements are transferred in chunks of chunk_size elements, with up to window chunks in flight,
+// the returned future covers the whole transfer, which advances like a continuation, i.e. when the host waits for any continuation
+// or calls offload::progress(), so the host can wait for, or work on, other things meanwhile
+template<typename T>
+future<void> put_chunked(T* local_source, buffer_ptr<T>& remote_dest, size_t n, size_t chunk_size, size_t window = constants::CHUNK_WINDOW)
+{
+	return detail::chunked(true, local_source, remote_dest, n, chunk_size, window, detail::no_chunk_callback());
+}
+
+// like above, calls callback(remote_dest, offset, count) on the target after each chunk arrived,
+// e.g. to start computing on a chunk while the next ones are still in flight
+// NOTE: Callback is a functor type, that is transferred like any functor
+template<typename T, typename Callback>
+future<void> put_chunked(T* local_source, buffer_ptr<T>& remote_dest, size_t n, size_t chunk_size, size_t window, const Callback& callback)
+{
+	return detail::chunked(true, local_source, remote_dest, n, chunk_size, window, callback);
+}
+
+template<typename T>
+future<void> get_chunked(buffer_ptr<T> remote_source, T* local_dest, size_t n, size_t chunk_size, size_t window = constants::CHUNK_WINDOW)
+{
+	return detail::chunked(false, local_dest, remote_source, n, chunk_size, window, detail::no_chunk_callback());
+}
 
 // TODO(feature): new API elements
 // construct/destruct remote objects => object_ptr
@@ -6,9 +6,15 @@
 #ifndef ham_offload_offload_msg_hpp
 #define ham_offload_offload_msg_hpp
 
+#include <cstddef>
+#include <cstring> // memcpy
+#include <type_traits>
+#include <vector>
+
 #include "ham/msg/active_msg.hpp"
 #include "ham/msg/execution_policy.hpp"
 #include "ham/misc/constants.hpp"
+#include "ham/misc/traits.hpp"
 #include "ham/misc/types.hpp"
 #include "ham/net/communicator.hpp"
 #include "ham/util/debug.hpp"
@@ -20,9 +26,12 @@ namespace detail {
 
 using ::ham::detail::result_container;
 using ::ham::msg::default_execution_policy;
+using ::ham::msg::execution_policy_direct;
+using ::ham::msg::execution_policy_pool;
 using ::ham::msg::active_msg;
 using ::ham::net::communicator;
 using ::ham::net::buffer_ptr;
+using ::ham::net::reply_descriptor;
 
 template<typename Functor, typename Result>
 struct helper {
@@ -39,8 +48,17 @@ struct helper<Functor, void> {
 	}
 };
 
+// selects the execution policy for offloading Functor at compile time:
+// potentially blocking functors are executed by the workers of the target (if there are any), so that they cannot stall the receive loop,
+// non-blocking ones directly by the receiving thread, with the lowest latency, see is_blocking
+template<class Functor>
+struct execution_policy_of {
+	template<class Derived>
+	using type = typename std::conditional<is_blocking<Functor>::value, execution_policy_pool<Derived>, execution_policy_direct<Derived>>::type;
+};
+
 // executes the functor, and send back its result
-template<class Functor, template<class> class ExecutionPolicy = default_execution_policy>
+template<class Functor, template<class> class ExecutionPolicy = execution_policy_of<Functor>::template type>
 class offload_result_msg
 	: public active_msg<offload_result_msg<Functor, ExecutionPolicy>, ExecutionPolicy>
 	, public Functor
@@ -49,23 +67,147 @@ public:
 	using Result = typename Functor::result_type;
 
 	offload_result_msg(Functor& f, const communicator::request& req)
-	 : Functor(std::forward<Functor>(f)), req(req) { }
+	 : Functor(std::forward<Functor>(f)), reply(req.reply()) { }
 
 	offload_result_msg(Functor&& f, const communicator::request& req)
-	 : Functor(std::forward<Functor>(f)), req(req) { }
+	 : Functor(std::forward<Functor>(f)), reply(req.reply()) { }
 
 	void operator()() //const
 	{
 		result_container<Result> result = helper<Functor, Result>::execute(*static_cast<Functor*>(this)); // this helper stuff is needed to handle void without too much code redundancy
-		HAM_DEBUG( HAM_LOG << "offload_result_msg::operator()(): this = " << (void*)this << " sending result via req(" << req.target_node << ", " << req.target_buffer_index << ", " << req.source_node << ", " << req.source_buffer_index << ")" << std::endl; )
-		req.send_result((void*)&result, sizeof result);
+		HAM_DEBUG( HAM_LOG << "offload_result_msg::operator()(): this = " << (void*)this << " sending result via reply(" << reply.source_node << ", " << reply.source_buffer_index << ")" << std::endl; )
+		communicator::instance().send_result(reply, (void*)&result, sizeof result);
+	}
+private:
+	reply_descriptor reply;
+};
+
+// rendezvous variant of offload_result_msg for functors that exceed the message buffer size,
+// the functor is transferred separately into a staging buffer on the target:
+// one-sided: the sender allocates the staging buffer and writes the functor before sending this message
+// two-sided: the receiver allocates the staging buffer and receives the functor matching data_tag
+template<class Functor, template<class> class ExecutionPolicy = execution_policy_of<Functor>::template type>
+class offload_rendezvous_result_msg
+	: public active_msg<offload_rendezvous_result_msg<Functor, ExecutionPolicy>, ExecutionPolicy>
+{
+public:
+	using Result = typename Functor::result_type;
+
+	offload_rendezvous_result_msg(const communicator::request& req, buffer_ptr<char> staging, int data_tag)
+	 : reply(req.reply()), staging(staging), data_tag(data_tag) { }
+
+	void operator()() //const
+	{
+		communicator& comm = communicator::instance();
+#ifndef HAM_COMM_ONE_SIDED
+		staging = comm.allocate_buffer<char>(sizeof(Functor), comm.this_node());
+		comm.recv_data(buffer_ptr<char>(nullptr, reply.source_node), staging.get(), sizeof(Functor), data_tag); // NOTE: nullptr, see offload_write_msg
+#endif
+		HAM_DEBUG( HAM_LOG << "offload_rendezvous_result_msg::operator()(): executing functor of " << sizeof(Functor) << " B from staging buffer " << (void*)staging.get() << std::endl; )
+		// NOTE: the functor is a sequence of bytes, just like the messages, so it is never destructed
+		result_container<Result> result = helper<Functor, Result>::execute(*reinterpret_cast<Functor*>(staging.get()));
+		comm.free_buffer(staging);
+		comm.send_result(reply, (void*)&result, sizeof result);
+	}
+private:
+	reply_descriptor reply;
+
+	buffer_ptr<char> staging; // on this node
+	int data_tag; // matches the send operation of the functor, only used by two-sided communicators
+};
+
+// layout of a batch frame, see offload::batch:
+// a sequence of items, each item is [size of the item][padding][active message], and starts at a multiple of BATCH_ALIGNMENT
+constexpr size_t BATCH_ALIGNMENT = alignof(std::max_align_t);
+constexpr size_t batch_align(size_t size) { return (size + BATCH_ALIGNMENT - 1) / BATCH_ALIGNMENT * BATCH_ALIGNMENT; }
+constexpr size_t BATCH_ITEM_HEADER_SIZE = batch_align(sizeof(size_t));
+
+// the result frame of the batch that is executed by the calling thread
+inline char*& batch_results()
+{
+	static thread_local char* results = nullptr;
+	return results;
+}
+
+// an item of a batch frame: executes the functor, and stores its result inside the result frame of the batch
+template<class Functor>
+class offload_batch_item_msg
+	: public active_msg<offload_batch_item_msg<Functor>, msg::execution_policy_direct>
+	, public Functor
+{
+public:
+	using Result = typename Functor::result_type;
+
+	offload_batch_item_msg(Functor& f, size_t result_offset)
+	 : Functor(std::forward<Functor>(f)), result_offset(result_offset) { }
+
+	offload_batch_item_msg(Functor&& f, size_t result_offset)
+	 : Functor(std::forward<Functor>(f)), result_offset(result_offset) { }
+
+	void operator()() //const
+	{
+		result_container<Result> result = helper<Functor, Result>::execute(*static_cast<Functor*>(this));
+		memcpy(batch_results() + result_offset, (void*)&result, sizeof result); // NOTE: results are transferred as byte sequences
+	}
+private:
+	size_t result_offset; // inside the result frame
+};
+
+// executes the items of a batch frame in order, and sends back all their results as a single result frame
+// NOTE: the frame follows this message inside the same message buffer, at offset batch_align(sizeof(offload_batch_msg))
+class offload_batch_msg
+	: public active_msg<offload_batch_msg, default_execution_policy>
+{
+public:
+	offload_batch_msg(const communicator::request& req, size_t count, size_t result_size)
+	 : reply(req.reply()), count(count), result_size(result_size) { }
+
+	void operator()() //const
+	{
+		std::vector<char> results(result_size);
+		batch_results() = results.data();
+
+		char* item = reinterpret_cast<char*>(this) + batch_align(sizeof(offload_batch_msg));
+		for (size_t i = 0; i < count; ++i) {
+			size_t item_size;
+			memcpy(&item_size, item, sizeof item_size);
+			void* item_msg = item + BATCH_ITEM_HEADER_SIZE;
+			auto functor = *reinterpret_cast<msg::active_msg_base*>(item_msg); // same as runtime::run_receive()
+			functor(item_msg);
+			item += item_size;
+		}
+
+		batch_results() = nullptr;
+		HAM_DEBUG( HAM_LOG << "offload_batch_msg::operator()(): executed " << count << " items, sending " << result_size << " B of results via reply(" << reply.source_node << ", " << reply.source_buffer_index << ")" << std::endl; )
+		communicator::instance().send_result(reply, (void*)results.data(), result_size);
 	}
 private:
-	communicator::request req; // TODO(improvement, high priority): use a subset of req here!
+	reply_descriptor reply;
+
+	size_t count; // items inside the frame
+	size_t result_size; // size of the result frame
+};
+
+// executes the functor, but discards its result, used by ping(), where the target only acknowledges the execution,
+// which returns the message buffer of the call
+template<class Functor>
+class discard_result
+	: public Functor
+{
+public:
+	using result_type = void;
+
+	discard_result(Functor&& f)
+	 : Functor(std::forward<Functor>(f)) { }
+
+	void operator()()
+	{
+		Functor::operator()();
+	}
 };
 
 // just execute the functor
-template<class Functor, template<class> class ExecutionPolicy = default_execution_policy>
+template<class Functor, template<class> class ExecutionPolicy = execution_policy_of<Functor>::template type>
 class offload_msg
 	: public active_msg<offload_msg<Functor, ExecutionPolicy>, ExecutionPolicy>
 	, public Functor
@@ -85,25 +227,27 @@ class offload_write_msg
 	: public active_msg<offload_write_msg<T, ExecutionPolicy>, ExecutionPolicy>
 {
 public:
-	offload_write_msg(communicator::request req, node_t remote_node, T* local_dest, size_t n)
-	 : req(req), remote_node(remote_node), local_dest(local_dest), n(n) { }
+	static constexpr size_t result_size = sizeof(size_t); // the result is n
+
+	offload_write_msg(communicator::request req, node_t remote_node, T* local_dest, size_t n, int data_tag)
+	 : reply(req.reply()), remote_node(remote_node), local_dest(local_dest), n(n), data_tag(data_tag) { }
 
 	void operator()() //const
 	{
-		communicator::instance().recv_data(buffer_ptr<T>(nullptr, remote_node), local_dest, n); // NOTE: Why nullptr? This is for two-sided communicators, so we do not know the remote address, but match a send operation that has the address.
+		communicator::instance().recv_data(buffer_ptr<T>(nullptr, remote_node), local_dest, n, data_tag); // NOTE: Why nullptr? This is for two-sided communicators, so we do not know the remote address, but match a send operation that has the address.
 
 		// send a result to tell the sender, that the transfer is done
-		if (req.valid()) {
-			req.send_result((void*)&n, sizeof n);
+		if (reply.valid()) {
+			communicator::instance().send_result(reply, (void*)&n, sizeof n);
 		}
 	}
 private:
-	communicator::request req; // TODO(improvement, high priority): use a subset of req here!
+	reply_descriptor reply;
 
 	node_t remote_node;
 	T* local_dest;
 	size_t n;
-	
+	int data_tag; // matches the send operation of this transfer
 };
 
 template<typename T, template<class> class ExecutionPolicy = default_execution_policy>
@@ -111,28 +255,85 @@ class offload_read_msg
 	: public active_msg<offload_read_msg<T, ExecutionPolicy>, ExecutionPolicy>
 {
 public:
-	offload_read_msg(communicator::request req, node_t remote_node, T* local_source, size_t n)
-	 : req(req), remote_node(remote_node), local_source(local_source), n(n) { }
+	static constexpr size_t result_size = sizeof(size_t); // the result is n
+
+	offload_read_msg(communicator::request req, node_t remote_node, T* local_source, size_t n, int data_tag)
+	 : reply(req.reply()), remote_node(remote_node), local_source(local_source), n(n), data_tag(data_tag) { }
 
 	void operator()() //const
 	{
-		communicator::instance().send_data(local_source, buffer_ptr<T>(nullptr, remote_node), n);  // NOTE: Why nullptr? This is for two-sided communicators, so we do not know the remote address, but match a receive operation that has the address.
+		communicator::instance().send_data(local_source, buffer_ptr<T>(nullptr, remote_node), n, data_tag);  // NOTE: Why nullptr? This is for two-sided communicators, so we do not know the remote address, but match a receive operation that has the address.
 		
 		// send a result message to tell the sender, that the transfer is done
-		if (req.valid()) {
-			req.send_result((void*)&n, sizeof n);
+		if (reply.valid()) {
+			communicator::instance().send_result(reply, (void*)&n, sizeof n);
 		}
 	}
 private:
-	communicator::request req; // TODO(improvement, high priority): use a subset of req here!
+	reply_descriptor reply;
 
 	node_t remote_node;
 	T* local_source;
 	size_t n;
+	int data_tag; // matches the receive operation of this transfer
+};
+
+// small variant of offload_write_msg, the data follows this message inside the same message buffer,
+// at offset payload_offset(), so there is no separate data transfer
+template<typename T, template<class> class ExecutionPolicy = default_execution_policy>
+class offload_write_inline_msg
+	: public active_msg<offload_write_inline_msg<T, ExecutionPolicy>, ExecutionPolicy>
+{
+public:
+	static constexpr size_t result_size = sizeof(size_t); // the result is n
+
+	static constexpr size_t payload_offset() { return batch_align(sizeof(offload_write_inline_msg)); }
+
+	offload_write_inline_msg(communicator::request req, T* local_dest, size_t n)
+	 : reply(req.reply()), local_dest(local_dest), n(n) { }
+
+	void operator()() //const
+	{
+		memcpy((void*)local_dest, reinterpret_cast<char*>(this) + payload_offset(), n * sizeof(T));
+		communicator::instance().send_result(reply, (void*)&n, sizeof n);
+	}
+private:
+	reply_descriptor reply;
+
+	T* local_dest;
+	size_t n;
+};
+
+// small variant of offload_read_msg, the data is sent back as the result,
+// which the sender receives directly into its destination
+template<typename T, template<class> class ExecutionPolicy = default_execution_policy>
+class offload_read_inline_msg
+	: public active_msg<offload_read_inline_msg<T, ExecutionPolicy>, ExecutionPolicy>
+{
+public:
+	offload_read_inline_msg(communicator::request req, T* local_source, size_t n)
+	 : reply(req.reply()), local_source(local_source), n(n) { }
+
+	void operator()() //const
+	{
+		communicator::instance().send_result(reply, (void*)local_source, n * sizeof(T));
+	}
+private:
+	reply_descriptor reply;
+
+	T* local_source;
+	size_t n;
 };
 
 } // namespace detail
 } // namespace offload
+
+// a functor with discarded result is as blocking as the functor itself
+template<class Functor>
+struct is_blocking<offload::detail::discard_result<Functor>> {
+	static constexpr bool value = is_blocking<Functor>::value;
+};
+
 } // namespace ham
 
 #endif // ham_offload_offload_msg_hpp
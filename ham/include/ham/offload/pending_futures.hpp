@@ -0,0 +1,241 @@
+// Copyright (c) 2013-2026 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#ifndef ham_offload_pending_futures_hpp
+#define ham_offload_pending_futures_hpp
+
+#include "ham/net/communicator.hpp" // must be included first for Intel MPI
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "ham/misc/types.hpp"
+
+namespace ham {
+namespace offload {
+namespace detail {
+
+// NOTE: credit-based flow control
+//       every request occupies message buffers (credits) to its peer, until its future is consumed by get() or destructed,
+//       when a new request finds no credits left, the oldest pending future to that peer is completed in advance:
+//       its result is fetched from the message buffer into the future itself, and the request is freed
+//       for this purpose, all futures that hold a request are linked into a FIFO per peer
+//       the requests of ping() have no future, they are kept in a second FIFO per peer, which is reclaimed first
+
+// the part of future<T> managed by pending_futures
+class pending_future {
+public:
+	enum state_t { NOT_PENDING, LINKED, FETCHING, FETCHED };
+
+	using fetch_function = void (*)(pending_future*); // waits for the result, stores it in the future, and frees the request
+
+protected:
+	pending_future() = default;
+	pending_future(const pending_future&) = delete;
+	pending_future& operator=(const pending_future&) = delete;
+
+private:
+	pending_future* prev = nullptr;
+	pending_future* next = nullptr;
+	node_t node = 0;
+	fetch_function fetch = nullptr;
+	std::atomic<int> state { NOT_PENDING };
+
+	friend class pending_futures;
+};
+
+class pending_futures {
+public:
+	explicit pending_futures(size_t nodes) : queues(new queue[nodes]) { }
+
+	// appends f to the FIFO of node
+	void push(pending_future& f, node_t node, pending_future::fetch_function fetch)
+	{
+		queue& q = queues[node];
+		std::lock_guard<std::mutex> lock(q.mutex);
+		f.node = node;
+		f.fetch = fetch;
+		f.prev = q.tail;
+		f.next = nullptr;
+		if (q.tail)
+			q.tail->next = &f;
+		else
+			q.head = &f;
+		q.tail = &f;
+		f.state.store(pending_future::LINKED, std::memory_order_relaxed);
+	}
+
+	// called by the owner of f before using its result,
+	// returns true if the result was fetched in advance and is stored inside f, false if it is still inside the message buffer
+	bool complete(pending_future& f)
+	{
+		if (f.state.load(std::memory_order_acquire) == pending_future::NOT_PENDING)
+			return false;
+
+		{
+			std::lock_guard<std::mutex> lock(queues[f.node].mutex);
+			if (f.state.load(std::memory_order_relaxed) == pending_future::LINKED) {
+				unlink(f);
+				f.state.store(pending_future::NOT_PENDING, std::memory_order_relaxed);
+				return false;
+			}
+		}
+
+		wait_fetched(f);
+		f.state.store(pending_future::NOT_PENDING, std::memory_order_relaxed);
+		return true;
+	}
+
+	// evaluates test() for f, which must not run concurrently with fetching f's result in advance,
+	// returns true without calling test() if the result was fetched in advance
+	template<typename Test>
+	bool test(pending_future& f, Test test)
+	{
+		if (f.state.load(std::memory_order_acquire) == pending_future::NOT_PENDING)
+			return test();
+
+		{
+			std::lock_guard<std::mutex> lock(queues[f.node].mutex);
+			if (f.state.load(std::memory_order_relaxed) == pending_future::LINKED)
+				return test();
+		}
+
+		return f.state.load(std::memory_order_acquire) == pending_future::FETCHED;
+	}
+
+	// called when the pending future other is moved into f,
+	// returns true if the result was fetched in advance and must be moved from other into f
+	bool take_over(pending_future& f, pending_future& other)
+	{
+		if (other.state.load(std::memory_order_acquire) == pending_future::NOT_PENDING)
+			return false;
+
+		{
+			std::lock_guard<std::mutex> lock(queues[other.node].mutex);
+			if (other.state.load(std::memory_order_relaxed) == pending_future::LINKED) {
+				// f replaces other inside the FIFO
+				f.node = other.node;
+				f.fetch = other.fetch;
+				f.prev = other.prev;
+				f.next = other.next;
+				(f.prev ? f.prev->next : queues[f.node].head) = &f;
+				(f.next ? f.next->prev : queues[f.node].tail) = &f;
+				f.state.store(pending_future::LINKED, std::memory_order_relaxed);
+				other.state.store(pending_future::NOT_PENDING, std::memory_order_relaxed);
+				return false;
+			}
+		}
+
+		wait_fetched(other);
+		other.state.store(pending_future::NOT_PENDING, std::memory_order_relaxed);
+		f.state.store(pending_future::FETCHED, std::memory_order_relaxed);
+		return true;
+	}
+
+	// appends the request of a ping() to the FIFO of its target, after reclaiming the finished ones, so that they do not pile up
+	void push_ping(const net::communicator::request& req)
+	{
+		queue& q = queues[req.target_node];
+		std::lock_guard<std::mutex> lock(q.mutex);
+		reclaim_pings(q);
+		q.pings.push_back(req);
+	}
+
+	// frees the requests of all pings to node, whose acknowledgements already arrived, without blocking,
+	// returns the number of freed requests
+	size_t reclaim_pings(node_t node)
+	{
+		queue& q = queues[node];
+		std::lock_guard<std::mutex> lock(q.mutex);
+		return reclaim_pings(q);
+	}
+
+	// waits for the reply of the oldest ping() to node and frees its request, returns false if there is none
+	bool fetch_oldest_ping(node_t node)
+	{
+		queue& q = queues[node];
+		net::communicator::request req;
+		{
+			std::lock_guard<std::mutex> lock(q.mutex);
+			if (q.pings.empty())
+				return false;
+			req = q.pings.front();
+			q.pings.pop_front();
+		}
+
+		req.get(); // NOTE: the reply is only an acknowledgement
+		net::communicator::instance().free_request(req);
+		return true;
+	}
+
+	// fetches the result of the oldest pending future to node, or reclaims the oldest ping() to node, returns false if there is none
+	bool fetch_oldest(node_t node)
+	{
+		if (fetch_oldest_ping(node))
+			return true;
+
+		queue& q = queues[node];
+		pending_future* f = nullptr;
+		{
+			std::lock_guard<std::mutex> lock(q.mutex);
+			f = q.head;
+			if (f == nullptr)
+				return false;
+			unlink(*f);
+			f->state.store(pending_future::FETCHING, std::memory_order_relaxed);
+		}
+
+		f->fetch(f);
+		f->state.store(pending_future::FETCHED, std::memory_order_release); // NOTE: f may be destructed by its owner from here on
+		return true;
+	}
+
+private:
+	struct queue {
+		std::mutex mutex;
+		pending_future* head = nullptr; // oldest
+		pending_future* tail = nullptr; // newest
+		std::deque<net::communicator::request> pings; // requests of ping(), oldest first
+	};
+
+	// NOTE: the lock of q must be held
+	static size_t reclaim_pings(queue& q)
+	{
+		size_t n = 0;
+		while (!q.pings.empty() && q.pings.front().test()) {
+			net::communicator::instance().free_request(q.pings.front());
+			q.pings.pop_front();
+			++n;
+		}
+		return n;
+	}
+
+	// NOTE: the lock of f's queue must be held
+	void unlink(pending_future& f)
+	{
+		queue& q = queues[f.node];
+		(f.prev ? f.prev->next : q.head) = f.next;
+		(f.next ? f.next->prev : q.tail) = f.prev;
+		f.prev = f.next = nullptr;
+	}
+
+	// another thread is fetching the result of f
+	static void wait_fetched(pending_future& f)
+	{
+		while (f.state.load(std::memory_order_acquire) != pending_future::FETCHED)
+			std::this_thread::yield();
+	}
+
+	std::unique_ptr<queue[]> queues;
+};
+
+} // namespace detail
+} // namespace offload
+} // namespace ham
+
+#endif // ham_offload_pending_futures_hpp
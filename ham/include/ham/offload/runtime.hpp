@@ -9,9 +9,17 @@
 #include "ham/net/communicator.hpp" // must be included first for Intel MPI
 
 #include <atomic>
+#ifdef HAM_COMM_THREADS
+#include <memory>
+#include <thread>
+#include <vector>
+#endif
 
+#include "ham/misc/traits.hpp"
 #include "ham/misc/types.hpp"
 #include "ham/msg/active_msg.hpp"
+#include "ham/offload/continuations.hpp"
+#include "ham/offload/pending_futures.hpp"
 #include "ham/util/debug.hpp"
 #include "ham/util/log.hpp"
 
@@ -42,24 +50,49 @@ public:
 	void terminate_workers();
 	int run_receive();
 
-	bool abort() { return abort_flag.exchange(true); }
+	bool abort() { return abort_flag().exchange(true); }
 
 	static runtime& instance() { return *instance_; }
 
 	net::communicator& communicator() { return comm; } 
+	detail::pending_futures& pending_futures() { return pending_futures_; }
+	detail::continuations& continuations() { return continuations_; }
 
 	node_t this_node() { return comm.this_node(); }
 	int num_nodes() { return comm.num_nodes(); }
 	bool is_host() { return comm.is_host(); }
 
 private:
+	void check_msg_handler_registry(); // host only, exits if the binaries of host and targets do not match
+
+#ifdef HAM_COMM_THREADS
+	// NOTE: all target threads share this runtime, so each node needs its own abort flag
+	std::atomic_bool& abort_flag() { return abort_flags[this_node()]; }
+#else
+	std::atomic_bool& abort_flag() { return abort_flag_; }
+#endif
+
 	static runtime* instance_;
-	std::atomic_bool abort_flag;
+#ifdef HAM_COMM_THREADS
+	std::unique_ptr<std::atomic_bool[]> abort_flags;
+	std::vector<std::thread> target_threads; // one per offload target, running run_receive()
+#else
+	std::atomic_bool abort_flag_;
+#endif
 	net::communicator_options comm_options;
 	net::communicator comm;
+	detail::pending_futures pending_futures_; // futures holding a request, per target, see pending_futures.hpp
+	detail::continuations continuations_; // see continuations.hpp
 };
 
 } // namespace offload
+
+// NOTE: terminating only sets the abort flag of the receive loop, so it is executed by the receiving thread
+template<>
+struct is_blocking<offload::runtime::terminate_functor> {
+	static constexpr bool value = false;
+};
+
 } // namespace ham
 
 #endif // ham_offload_runtime_hpp
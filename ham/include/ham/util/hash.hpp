@@ -0,0 +1,43 @@
+// Copyright (c) 2013-2026 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+/**
+ * @file
+ * 64 bit FNV-1a hash, usable at compile time (C++11 constexpr).
+ */
+
+#ifndef ham_util_hash_hpp
+#define ham_util_hash_hpp
+
+#include <cstddef> // size_t
+#include <cstdint>
+
+namespace ham {
+namespace util {
+
+constexpr uint64_t FNV1A_OFFSET_BASIS = 0xcbf29ce484222325ull;
+constexpr uint64_t FNV1A_PRIME = 0x100000001b3ull;
+
+namespace detail {
+
+constexpr uint64_t fnv1a_linear(const char* data, size_t size, uint64_t hash)
+{
+	return size == 0 ? hash : fnv1a_linear(data + 1, size - 1, (hash ^ static_cast<uint8_t>(*data)) * FNV1A_PRIME);
+}
+
+} // namespace detail
+
+// hashes size bytes of data, hash allows to continue a previous hash
+// NOTE: the bytes are processed in order, but recursively split in halves,
+//       so that the constexpr recursion depth grows logarithmically with size, e.g. for long type names
+constexpr uint64_t fnv1a(const char* data, size_t size, uint64_t hash = FNV1A_OFFSET_BASIS)
+{
+	return size <= 16 ? detail::fnv1a_linear(data, size, hash) : fnv1a(data + size / 2, size - size / 2, fnv1a(data, size / 2, hash));
+}
+
+} // namespace util
+} // namespace ham
+
+#endif // ham_util_hash_hpp
@@ -53,13 +53,11 @@ void offload_copy_out(offload::buffer_ptr<char> remote, char* local, size_t data
 	offload::get_sync(remote, local, data_size); //sync
 }
 
-#ifndef HAM_COMM_ONE_SIDED
 // no LEO/OpenMP equivalent
 void offload_copy_direct(offload::buffer_ptr<char> source, offload::buffer_ptr<char> dest, size_t data_size)
 {
-	offload::copy_sync(source, dest, data_size); // TODO: use async
+	offload::copy_sync(source, dest, data_size);
 }
-#endif
 
 float fun_mul(float a, float b)
 {
@@ -144,6 +142,9 @@ int main(int argc, char * argv[])
 	#endif
 
 		std::cout << "# HAM_MESSAGE_SIZE             " << HAM_MESSAGE_SIZE << std::endl;
+		std::cout << "# call message size            " << sizeof(offload::detail::offload_result_msg<decltype(f2f(&fun))>) << std::endl;
+		std::cout << "# call-mul message size        " << sizeof(offload::detail::offload_result_msg<decltype(f2f(&fun_mul, 0.0f, 0.0f))>) << std::endl;
+		std::cout << "# copy message size            " << sizeof(offload::detail::offload_write_msg<char>) << std::endl;
 
 	#ifdef HAM_COMM_ONE_SIDED
 		std::cout << "# HAM_COMM_ONE_SIDED           enabled" << std::endl;
@@ -157,6 +158,24 @@ int main(int argc, char * argv[])
 		std::cout << "# HAM_COMM_MPI                 disabled" << std::endl;
 	#endif
 
+	#ifdef HAM_COMM_MPI_RMA
+		std::cout << "# HAM_COMM_MPI_RMA             enabled" << std::endl;
+	#else
+		std::cout << "# HAM_COMM_MPI_RMA             disabled" << std::endl;
+	#endif
+
+	#ifdef HAM_COMM_SHM
+		std::cout << "# HAM_COMM_SHM                 enabled" << std::endl;
+	#else
+		std::cout << "# HAM_COMM_SHM                 disabled" << std::endl;
+	#endif
+
+	#ifdef HAM_COMM_THREADS
+		std::cout << "# HAM_COMM_THREADS             enabled" << std::endl;
+	#else
+		std::cout << "# HAM_COMM_THREADS             disabled" << std::endl;
+	#endif
+
 	#ifdef HAM_COMM_VEO
 		std::cout << "# HAM_COMM_VEO                 enabled" << std::endl;
 	#else
@@ -0,0 +1,109 @@
+// Copyright (c) 2013-2026 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// Measures the offload call throughput when multiple host threads offload concurrently.
+// Host thread i offloads to target 1 + i % (num_nodes - 1).
+
+#include "ham/offload.hpp"
+
+#include <CLI/CLI11.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace ham;
+
+int fun_add(int a, int b)
+{
+	return a + b;
+}
+
+int main(int argc, char * argv[])
+{
+	// document command line
+	std::cout << "# Command line was: " << std::endl << "# ";
+	for (int i = 0; i < argc; ++i)
+		std::cout << argv[i] << " ";
+	std::cout << std::endl;
+
+	// configuration and default values
+	unsigned int runs = 1000;
+	unsigned int max_threads = 4;
+	bool async = false;
+
+	// command line options
+	CLI::App app("Supported options");
+	app.allow_extras(); // ignore options for HAM
+	app.add_option("--runs,-r", runs, "number of offloaded calls per host thread");
+	app.add_option("--threads,-t", max_threads, "maximum number of host threads, the benchmark runs for 1 to this number of threads");
+	app.add_flag("--async,-y", async, "keep all calls of a thread in flight, before collecting the results");
+
+	CLI11_PARSE(app, argc, argv);
+
+	const node_t targets = offload::num_nodes() - 1;
+	if (targets < 1) {
+		cerr << "Error: at least one offload target is required." << endl;
+		return EXIT_FAILURE;
+	}
+
+	std::cout << "# targets: " << targets << ", runs per thread: " << runs << ", async: " << (async ? "yes" : "no") << std::endl;
+	std::cout << "threads\tcalls\ttime_s\tcalls_per_s" << std::endl;
+
+	for (unsigned int thread_count = 1; thread_count <= max_threads; ++thread_count)
+	{
+		std::atomic<size_t> errors(0);
+		std::vector<std::thread> threads;
+		threads.reserve(thread_count);
+
+		const auto start = std::chrono::steady_clock::now();
+
+		for (unsigned int t = 0; t < thread_count; ++t)
+		{
+			threads.emplace_back([&, t]() {
+				const node_t target = 1 + t % targets;
+				if (async) {
+					// NOTE: the threads share the message buffers of a target, some backends keep one of them pre-allocated,
+					//       so each thread keeps at most half of its share in flight
+					const size_t batch = std::max<size_t>(1, constants::MSG_BUFFERS / 2 / thread_count);
+					std::vector<offload::future<int>> futures;
+					futures.reserve(batch);
+					for (size_t i = 0; i < runs; i += batch) {
+						for (size_t j = i; j < std::min<size_t>(i + batch, runs); ++j)
+							futures.push_back(offload::async(target, f2f(&fun_add, static_cast<int>(t), static_cast<int>(j))));
+						for (size_t j = 0; j < futures.size(); ++j)
+							if (futures[j].get() != static_cast<int>(t + i + j))
+								++errors;
+						futures.clear();
+					}
+				} else {
+					for (size_t i = 0; i < runs; ++i)
+						if (offload::sync(target, f2f(&fun_add, static_cast<int>(t), static_cast<int>(i))) != static_cast<int>(t + i))
+							++errors;
+				}
+			});
+		}
+
+		for (auto& thread : threads)
+			thread.join();
+
+		const std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+		const size_t calls = static_cast<size_t>(thread_count) * runs;
+
+		std::cout << thread_count << "\t" << calls << "\t" << time.count() << "\t" << (calls / time.count()) << std::endl;
+
+		if (errors != 0) {
+			cerr << "Error: " << errors << " wrong results with " << thread_count << " host threads." << endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
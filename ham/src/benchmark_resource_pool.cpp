@@ -0,0 +1,133 @@
+// Copyright (c) 2013-2026 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// Micro-benchmark of ham::detail::resource_pool, which manages the message buffer indices on every send,
+// compared to the previous std::stack based implementation protected by a mutex.
+// Each thread repeatedly allocates a number of indices and frees them again.
+
+#include "ham/misc/constants.hpp"
+#include "ham/misc/resource_pool.hpp"
+
+#include <CLI/CLI11.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <stack>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace ham;
+
+// the previous resource_pool implementation, made thread-safe by a mutex
+template<typename T>
+class locked_resource_pool
+{
+public:
+	using value_type = T;
+
+	void add(value_type v)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		free_stack.push(v);
+	}
+
+	value_type allocate()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!free_stack.empty()) {
+			value_type result = free_stack.top();
+			free_stack.pop();
+			return result;
+		}
+		std::cerr << "locked_resource_pool::allocate(), error: ran out of resources, returning default object." << std::endl;
+		return value_type();
+	}
+
+	void free(value_type& v)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		free_stack.emplace(v);
+	}
+
+private:
+	std::stack<value_type, std::vector<value_type>> free_stack;
+	std::mutex mutex;
+};
+
+// returns the throughput in allocate()/free() pairs per second
+template<typename Pool>
+double run(unsigned int thread_count, size_t runs, size_t in_flight)
+{
+	Pool pool;
+	for (size_t j = constants::MSG_BUFFERS; j > 0; --j)
+		pool.add(j-1);
+
+	std::vector<std::thread> threads;
+	threads.reserve(thread_count);
+
+	const auto start = std::chrono::steady_clock::now();
+
+	for (unsigned int t = 0; t < thread_count; ++t)
+	{
+		threads.emplace_back([&]() {
+			std::vector<size_t> values(in_flight);
+			for (size_t i = 0; i < runs; i += in_flight) {
+				for (size_t j = 0; j < in_flight; ++j)
+					values[j] = pool.allocate();
+				for (size_t j = 0; j < in_flight; ++j)
+					pool.free(values[j]);
+			}
+		});
+	}
+
+	for (auto& thread : threads)
+		thread.join();
+
+	const std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+	return (static_cast<double>(thread_count) * runs) / time.count();
+}
+
+int main(int argc, char * argv[])
+{
+	// document command line
+	std::cout << "# Command line was: " << std::endl << "# ";
+	for (int i = 0; i < argc; ++i)
+		std::cout << argv[i] << " ";
+	std::cout << std::endl;
+
+	// configuration and default values
+	size_t runs = 1000000;
+	unsigned int max_threads = std::max(1u, std::thread::hardware_concurrency());
+	size_t in_flight = 1;
+
+	// command line options
+	CLI::App app("Supported options");
+	app.add_option("--runs,-r", runs, "number of allocate()/free() pairs per thread");
+	app.add_option("--threads,-t", max_threads, "maximum number of threads, the benchmark runs for 1 to this number of threads");
+	app.add_option("--in-flight,-i", in_flight, "number of values each thread allocates before freeing them");
+
+	CLI11_PARSE(app, argc, argv);
+
+	if (in_flight == 0 || in_flight * max_threads > constants::MSG_BUFFERS) {
+		cerr << "Error: threads * in-flight must be between 1 and " << constants::MSG_BUFFERS << "." << endl;
+		return EXIT_FAILURE;
+	}
+
+	std::cout << "threads\tlock_free_per_s\tmutex_per_s\tspeedup" << std::endl;
+
+	for (unsigned int thread_count = 1; thread_count <= max_threads; ++thread_count)
+	{
+		const double lock_free = run<detail::resource_pool<size_t>>(thread_count, runs, in_flight);
+		const double locked = run<locked_resource_pool<size_t>>(thread_count, runs, in_flight);
+		std::cout << thread_count << "\t" << lock_free << "\t" << locked << "\t" << (lock_free / locked) << std::endl;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,8 @@
+// Copyright (c) 2013-2019 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "ham/net/communicator.hpp"
+
+ham::net::communicator* ham::net::communicator::instance_ = nullptr;
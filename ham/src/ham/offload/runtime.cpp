@@ -6,6 +6,7 @@
 #include "ham/offload/runtime.hpp"
 
 #include "ham/misc/options.hpp"
+#include "ham/msg/worker_pool.hpp"
 #include "ham/offload/offload.hpp"
 #include "ham/util/cpu_affinity.hpp"
 
@@ -14,7 +15,88 @@ namespace offload {
 
 runtime* runtime::instance_ = nullptr;
 
-runtime::runtime(int* argc_ptr, char** argv_ptr[]) : abort_flag(false), comm_options(argc_ptr, argv_ptr), comm(comm_options) // NOTE: communicator ctor, might change argc, argv values, e.g. MPI_Init
+namespace detail {
+
+// compares the message handler registry of an offload target with the one of the host
+class msg_handler_registry_check {
+public:
+	using result_type = bool;
+
+	msg_handler_registry_check(size_t size, uint64_t checksum) : size(size), checksum(checksum) { }
+
+	bool operator()() const
+	{
+		const bool match = size == msg::msg_handler_registry::size() && checksum == msg::msg_handler_registry::checksum();
+		if (!match) {
+			HAM_LOG << "msg_handler_registry_check: error: " << msg::msg_handler_registry::size() << " message handlers with checksum " << msg::msg_handler_registry::checksum()
+			        << " on this target, but " << size << " with checksum " << checksum << " on the host." << std::endl;
+			runtime::instance().abort(); // NOTE: this target cannot decode further messages reliably, its receive loop ends after replying
+		}
+		return match;
+	}
+
+private:
+	size_t size;
+	uint64_t checksum;
+};
+
+#ifdef HAM_MSG_HANDLER_REGISTRY_DIRECT_SELECTED
+// compares the relative handler addresses of an offload target with the ones of the host
+class msg_handler_registry_direct_check {
+public:
+	using result_type = bool;
+
+	explicit msg_handler_registry_direct_check(uint64_t offsets_checksum) : offsets_checksum(offsets_checksum) { }
+
+	bool operator()() const
+	{
+		return offsets_checksum == msg::msg_handler_registry::offsets_checksum();
+	}
+
+private:
+	uint64_t offsets_checksum;
+};
+
+class msg_handler_registry_direct_enable {
+public:
+	using result_type = void;
+
+	void operator()() const
+	{
+		msg::msg_handler_registry::enable_direct();
+	}
+};
+#endif
+
+} // namespace detail
+} // namespace offload
+
+// NOTE: the start-up checks are executed by the receiving thread of the target, while it does nothing else
+template<>
+struct is_blocking<offload::detail::msg_handler_registry_check> {
+	static constexpr bool value = false;
+};
+
+#ifdef HAM_MSG_HANDLER_REGISTRY_DIRECT_SELECTED
+template<>
+struct is_blocking<offload::detail::msg_handler_registry_direct_check> {
+	static constexpr bool value = false;
+};
+
+template<>
+struct is_blocking<offload::detail::msg_handler_registry_direct_enable> {
+	static constexpr bool value = false;
+};
+#endif
+
+namespace offload {
+
+runtime::runtime(int* argc_ptr, char** argv_ptr[]) :
+#ifndef HAM_COMM_THREADS
+	abort_flag_(false),
+#endif
+	comm_options(argc_ptr, argv_ptr), comm(comm_options), // NOTE: communicator ctor, might change argc, argv values, e.g. MPI_Init
+	pending_futures_(comm.num_nodes())
 {
 	HAM_DEBUG( HAM_LOG << "runtime::runtime()" << std::endl; )
 
@@ -24,11 +106,36 @@ runtime::runtime(int* argc_ptr, char** argv_ptr[]) : abort_flag(false), comm_opt
 		ham::util::set_cpu_affinity(comm_options.cpu_affinity());
 
 	instance_ = this;
+
+#ifdef HAM_COMM_THREADS
+	// the offload targets are threads of this process, start their receive loops
+	abort_flags.reset(new std::atomic_bool[num_nodes()]);
+	for (node_t node = 0; node < static_cast<node_t>(num_nodes()); ++node)
+		abort_flags[node] = false;
+
+	for (node_t node = 0; node < static_cast<node_t>(num_nodes()); ++node)
+	{
+		if (comm.is_host(node))
+			continue;
+		target_threads.emplace_back([this, node]() {
+			comm.attach(node);
+			run_receive();
+		});
+	}
+#endif
+
+	if (is_host())
+		check_msg_handler_registry();
 }
 
 runtime::~runtime()
 {
 	HAM_DEBUG( HAM_LOG << "runtime::~runtime" << std::endl; )
+#ifdef HAM_COMM_THREADS
+	// NOTE: the targets terminate after receiving terminate_functor from terminate_workers()
+	for (auto& thread : target_threads)
+		thread.join();
+#endif
 }
 
 // not needed if HAM_EXPLICIT is defined
@@ -43,8 +150,67 @@ int runtime::run_main()
 	return result;
 }
 
+void runtime::check_msg_handler_registry()
+{
+	std::vector<node_t> nodes;
+	std::vector<future<bool>> results;
+	for (node_t node = 0; node < static_cast<node_t>(num_nodes()); ++node) {
+		if (node != this_node()) {
+			nodes.push_back(node);
+			results.push_back(async(node, detail::msg_handler_registry_check(msg::msg_handler_registry::size(), msg::msg_handler_registry::checksum())));
+		}
+	}
+
+	bool match = true;
+	std::vector<bool> node_matches;
+	for (auto& result : results) {
+		node_matches.push_back(result.get());
+		match = node_matches.back() && match;
+	}
+	if (!match) {
+		HAM_LOG << "runtime::check_msg_handler_registry(): error: the binaries of host and targets do not match, aborting." << std::endl;
+		// the mismatching targets stopped by themselves, terminate the others, so that all nodes tear down cleanly,
+		// also without a job abort by the launcher (e.g. mpirun)
+		for (size_t i = 0; i < nodes.size(); ++i)
+			if (node_matches[i])
+				ping(nodes[i], terminate_functor());
+		for (size_t i = 0; i < nodes.size(); ++i) // wait for the acknowledgements
+			while (pending_futures_.fetch_oldest_ping(nodes[i]))
+				;
+		exit(EXIT_FAILURE);
+	}
+	HAM_DEBUG( HAM_LOG << "runtime::check_msg_handler_registry(): " << msg::msg_handler_registry::size() << " message handlers match on all nodes" << std::endl; )
+
+#ifdef HAM_MSG_HANDLER_REGISTRY_DIRECT_SELECTED
+	// use relative handler addresses as keys, if all binaries are identical, otherwise stay with the ABI registry
+	results.clear();
+	for (node_t node = 0; node < static_cast<node_t>(num_nodes()); ++node)
+		if (node != this_node())
+			results.push_back(async(node, detail::msg_handler_registry_direct_check(msg::msg_handler_registry::offsets_checksum())));
+	bool identical = true;
+	for (auto& result : results)
+		identical = result.get() && identical;
+	if (!identical) {
+		HAM_LOG << "runtime::check_msg_handler_registry(): warning: the binaries of host and targets are not identical, using the ABI message handler registry." << std::endl;
+		return;
+	}
+
+#ifndef HAM_COMM_THREADS // NOTE: all nodes share the registry of this process
+	for (node_t node = 0; node < static_cast<node_t>(num_nodes()); ++node)
+		if (node != this_node())
+			async(node, detail::msg_handler_registry_direct_enable()).get(); // NOTE: sent with the old keys, completed before switching
+#endif
+	msg::msg_handler_registry::enable_direct();
+	HAM_DEBUG( HAM_LOG << "runtime::check_msg_handler_registry(): using relative handler addresses as message handler keys" << std::endl; )
+#endif
+}
+
 void runtime::terminate_workers()
 {
+	// complete all continuations first, including detached futures, which may still need the targets
+	while (continuations_.progress() > 0)
+		std::this_thread::yield();
+
 	for (node_t node = 0; node < static_cast<node_t>(num_nodes()); ++node)
 	{
 		if(node != this_node())
@@ -53,12 +219,30 @@ void runtime::terminate_workers()
 			ping(node, terminate_functor());
 		}
 	}
+
+	// wait for the targets to acknowledge, which also returns the credits of all pings
+	for (node_t node = 0; node < static_cast<node_t>(num_nodes()); ++node)
+		while (pending_futures_.fetch_oldest_ping(node))
+			;
 }
 
 int runtime::run_receive()
 {
+	// worker threads for messages with execution_policy_pool, see --ham-target-threads
+	std::unique_ptr<msg::worker_pool> workers;
+	if (comm_options.target_threads() > 0) {
+#ifdef HAM_COMM_THREADS
+		const node_t node = this_node();
+		workers.reset(new msg::worker_pool(comm_options.target_threads(), [this, node]() { comm.attach(node); })); // the workers act on behalf of this target
+#else
+		workers.reset(new msg::worker_pool(comm_options.target_threads(), nullptr));
+#endif
+		msg::worker_pool::current() = workers.get();
+	}
+
 	// receive and execute active messages
-	while (!abort_flag)
+	// NOTE: with HAM_COMM_PEER_OFFLOAD, the messages come from the host and the other targets
+	while (!abort_flag())
 	{
 		HAM_DEBUG( HAM_LOG << "runtime::run_receive(), waiting for message" << std::endl; )
 		void* msg_buffer = comm.recv_msg_host();
@@ -67,7 +251,8 @@ int runtime::run_receive()
 		functor(msg_buffer); // call active_msg_base::operator()(msg_buffer) which calls execution_policy::handler()
 		HAM_DEBUG( HAM_LOG << "runtime::run_receive(), message execution done." << std::endl; )
 	}
-	HAM_DEBUG( HAM_LOG << "runtime::run_receive(), returning." << std::endl; )
+	msg::worker_pool::current() = nullptr;
+	HAM_DEBUG( HAM_LOG << "runtime::run_receive(), returning." << std::endl; ) // NOTE: the workers finish their remaining messages on destruction
 	return 0;
 }
 
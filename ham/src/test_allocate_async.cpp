@@ -0,0 +1,74 @@
+// Copyright (c) 2013-2026 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "ham/offload.hpp"
+#include <iostream>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+using namespace ham;
+
+int sum(offload::buffer_ptr<int> data, size_t n)
+{
+	return std::accumulate(data.get(), data.get() + n, 0);
+}
+
+int main(int argc, char* argv[])
+{
+	// avoid compiler warning
+	HAM_UNUSED_VAR(argc);
+	HAM_UNUSED_VAR(argv);
+
+	bool passed = true;
+	const size_t n = 1024;
+	const size_t buffers_per_target = 8;
+
+	std::vector<int> input(n);
+	std::iota(input.begin(), input.end(), 0);
+	const int input_sum = std::accumulate(input.begin(), input.end(), 0);
+
+	// issue the allocations on all targets together
+	std::vector<offload::future<offload::buffer_ptr<int>>> allocations;
+	for (node_t target = 0; target < static_cast<node_t>(offload::num_nodes()); ++target) {
+		if (target == offload::this_node())
+			continue;
+		for (size_t i = 0; i < buffers_per_target; ++i)
+			allocations.push_back(offload::allocate_async<int>(target, n));
+	}
+
+	std::vector<offload::buffer_ptr<int>> buffers;
+	for (auto& allocation : allocations) {
+		buffers.push_back(allocation.get());
+		passed = (buffers.back().get() != nullptr) && passed;
+	}
+
+	for (auto& buffer : buffers) {
+		offload::put(input.data(), buffer, n).get();
+		const int result = offload::sync(buffer.node(), f2f(&sum, buffer, n));
+		if (result != input_sum) {
+			std::cout << "Error: buffer on target " << buffer.node() << " returned " << result << ", expected " << input_sum << std::endl;
+			passed = false;
+		}
+	}
+
+	// free half of the buffers with futures, and detach the frees of the other half
+	std::vector<offload::future<void>> frees;
+	for (size_t i = 0; i < buffers.size(); ++i) {
+		if (i % 2 == 0)
+			frees.push_back(offload::free_async(buffers[i]));
+		else
+			offload::detach(offload::free_async(buffers[i]));
+	}
+	offload::when_all(std::move(frees)).get();
+
+	// the detached frees complete in the background
+	while (offload::progress() > 0)
+		std::this_thread::yield();
+
+	std::cout << (passed ? "Test passed." : "Test failed.") << std::endl;
+
+	return passed ? 0 : -1;
+}
@@ -0,0 +1,90 @@
+// Copyright (c) 2013-2026 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "ham/offload.hpp"
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+using namespace ham;
+
+int sum(offload::buffer_ptr<int> data, size_t n)
+{
+	return std::accumulate(data.get(), data.get() + n, 0);
+}
+
+int main(int argc, char* argv[])
+{
+	// avoid compiler warning
+	HAM_UNUSED_VAR(argc);
+	HAM_UNUSED_VAR(argv);
+
+	bool passed = true;
+	const size_t capacity = 1 << 20;
+	const size_t sizes[] = { 1, 15, 16, 17, 100, 1000, 4096 };
+	const size_t iterations = 100;
+
+	for (node_t target = 0; target < static_cast<node_t>(offload::num_nodes()); ++target) {
+		if (target == offload::this_node())
+			continue;
+
+		offload::arena arena(target, capacity);
+
+		// temporaries allocated and freed every iteration reuse the same blocks
+		std::vector<offload::buffer_ptr<int>> first;
+		for (size_t iteration = 0; iteration < iterations; ++iteration) {
+			std::vector<offload::buffer_ptr<int>> buffers;
+			for (size_t n : sizes) {
+				buffers.push_back(arena.allocate<int>(n));
+				passed = (buffers.back().get() != nullptr) && (buffers.back().node() == target) && passed;
+				passed = (reinterpret_cast<uintptr_t>(buffers.back().get()) % constants::ARENA_MIN_BLOCK == 0) && passed;
+			}
+			if (iteration == 0)
+				first = buffers;
+			for (size_t i = 0; i < buffers.size(); ++i)
+				passed = (buffers[i].get() == first[i].get()) && passed;
+
+			// the sub-buffers are usable and do not overlap
+			for (size_t i = 0; i < buffers.size(); ++i) {
+				std::vector<int> data(sizes[i]);
+				std::iota(data.begin(), data.end(), static_cast<int>(i));
+				offload::put(data.data(), buffers[i], sizes[i]).get();
+			}
+			for (size_t i = 0; i < buffers.size(); ++i) {
+				const int expected = static_cast<int>(sizes[i] * i + sizes[i] * (sizes[i] - 1) / 2);
+				const int result = offload::sync(target, f2f(&sum, buffers[i], sizes[i]));
+				if (result != expected) {
+					std::cout << "Error: target " << target << ", sub-buffer " << i << " returned " << result << ", expected " << expected << std::endl;
+					passed = false;
+				}
+			}
+
+			for (auto it = buffers.rbegin(); it != buffers.rend(); ++it) // freed blocks are reused last in, first out
+				arena.free(*it);
+		}
+		passed = (arena.used() == 0) && passed;
+
+		// exhaustion, and bulk release
+		arena.reset();
+		std::vector<offload::buffer_ptr<char>> blocks;
+		for (offload::buffer_ptr<char> block = arena.allocate<char>(1000); block.get() != nullptr; block = arena.allocate<char>(1000))
+			blocks.push_back(block);
+		passed = (blocks.size() == capacity / 1024) && (arena.used() == capacity) && passed;
+		arena.reset();
+		passed = (arena.used() == 0) && (arena.allocate<char>(capacity).get() == blocks.front().get()) && passed;
+
+		// requests beyond the capacity fail like exhaustion, also if their size in bytes overflows
+		arena.reset();
+		passed = (arena.allocate<char>(capacity + 1).get() == nullptr) && passed;
+		passed = (arena.allocate<int>(std::numeric_limits<size_t>::max() / sizeof(int) + 1).get() == nullptr) && passed;
+		passed = (arena.allocate<char>(std::numeric_limits<size_t>::max()).get() == nullptr) && (arena.used() == 0) && passed;
+	}
+
+	std::cout << (passed ? "Test passed." : "Test failed.") << std::endl;
+
+	return passed ? 0 : -1;
+}
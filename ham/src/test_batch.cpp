@@ -0,0 +1,116 @@
+// Copyright (c) 2013-2026 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "ham/offload.hpp"
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace ham;
+
+int square(int x)
+{
+	return x * x;
+}
+
+double scale(double x, double factor)
+{
+	return x * factor;
+}
+
+void nothing()
+{
+}
+
+// larger than a message buffer, so it cannot be part of a batch
+struct parameter_block {
+	int values[constants::MSG_SIZE / sizeof(int)];
+};
+
+int first_value(parameter_block block)
+{
+	return block.values[0];
+}
+
+int main(int argc, char* argv[])
+{
+	// avoid compiler warning
+	HAM_UNUSED_VAR(argc);
+	HAM_UNUSED_VAR(argv);
+
+	bool passed = true;
+	const int calls = 10000; // many batches
+
+	for (node_t target = 0; target < static_cast<node_t>(offload::num_nodes()); ++target) {
+		if (target == offload::this_node())
+			continue;
+
+		// mixed calls, sent whenever the message buffer is full
+		{
+			offload::batch batch(target);
+			std::vector<offload::future<int>> squares;
+			std::vector<offload::future<double>> scaled;
+			for (int i = 0; i < calls; ++i) {
+				squares.push_back(batch.async(f2f(&square, i)));
+				scaled.push_back(batch.async(f2f(&scale, static_cast<double>(i), 0.5)));
+				batch.async(f2f(&nothing)); // the future is discarded without sending the batch
+			}
+			batch.flush();
+
+			for (int i = 0; i < calls; ++i) {
+				const int result = squares[i].get();
+				if (result != i * i) {
+					std::cout << "Error: target " << target << ", call " << i << " returned " << result << ", expected " << (i * i) << std::endl;
+					passed = false;
+				}
+				passed = (scaled[i].get() == i * 0.5) && passed;
+			}
+		}
+
+		// auto-flush after a number of calls, and after a delay
+		{
+			offload::batch batch(target, 7);
+			std::vector<offload::future<int>> futures;
+			for (int i = 0; i < 20; ++i) {
+				futures.push_back(batch.async(f2f(&square, i)));
+				passed = (batch.size() == static_cast<size_t>((i + 1) % 7)) && passed;
+			}
+			for (int i = 0; i < 20; ++i)
+				passed = (futures[i].get() == i * i) && passed;
+
+			offload::batch delayed(target, 0, std::chrono::milliseconds(1));
+			auto f = delayed.async(f2f(&square, 3));
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+			auto g = delayed.async(f2f(&square, 4));
+			passed = (delayed.size() == 0) && passed;
+			passed = (f.get() == 9) && (g.get() == 16) && passed;
+		}
+
+		// get() sends an unsent batch, and further calls start a new one
+		{
+			offload::batch batch(target);
+			auto f = batch.async(f2f(&square, 5));
+			passed = (f.get() == 25) && passed;
+			auto g = batch.async(f2f(&square, 6));
+			passed = (g.get() == 36) && passed;
+		}
+
+		// calls that do not fit into a batch are offloaded on their own
+		// NOTE: with a larger --ham-msg-size, the call is part of the batch
+		{
+			parameter_block block;
+			block.values[0] = 42;
+			offload::batch batch(target);
+			auto f = batch.async(f2f(&first_value, block));
+			auto g = batch.async(f2f(&square, 7));
+			passed = (f.get() == 42) && (g.get() == 49) && passed;
+		}
+	}
+
+	std::cout << (passed ? "Test passed." : "Test failed.") << std::endl;
+
+	return passed ? 0 : -1;
+}
@@ -0,0 +1,75 @@
+// Copyright (c) 2013-2026 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "ham/offload.hpp"
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+using namespace ham;
+
+// called on the target for every chunk that arrived
+struct scale_chunk {
+	int factor;
+
+	void operator()(offload::buffer_ptr<int> buffer, size_t offset, size_t count)
+	{
+		for (size_t i = offset; i < offset + count; ++i)
+			buffer.get()[i] *= factor;
+	}
+};
+
+int main(int argc, char* argv[])
+{
+	// avoid compiler warning
+	HAM_UNUSED_VAR(argc);
+	HAM_UNUSED_VAR(argv);
+
+	bool passed = true;
+	const size_t n = 100000;
+	const size_t chunk_sizes[] = { 1000, 4096, 99999, n, 2 * n };
+
+	std::vector<int> input(n);
+	std::iota(input.begin(), input.end(), 0);
+
+	for (node_t target = 0; target < static_cast<node_t>(offload::num_nodes()); ++target) {
+		if (target == offload::this_node())
+			continue;
+
+		offload::buffer_ptr<int> buffer = offload::allocate<int>(target, n);
+
+		for (size_t chunk_size : chunk_sizes) {
+			// round-trip
+			std::vector<int> output(n, -1);
+			offload::put_chunked(input.data(), buffer, n, chunk_size).get();
+			offload::get_chunked(buffer, output.data(), n, chunk_size, 2).get();
+			if (output != input) {
+				std::cout << "Error: target " << target << ", chunk size " << chunk_size << ": round-trip mismatch" << std::endl;
+				passed = false;
+			}
+
+			// the target works on every chunk after it arrived
+			std::fill(output.begin(), output.end(), -1);
+			offload::put_chunked(input.data(), buffer, n, chunk_size, 3, scale_chunk { 2 })
+				.then([&]() { return offload::get_chunked(buffer, output.data(), n, chunk_size); })
+				.get();
+			for (size_t i = 0; i < n; ++i) {
+				if (output[i] != 2 * input[i]) {
+					std::cout << "Error: target " << target << ", chunk size " << chunk_size << ", element " << i << " is " << output[i] << ", expected " << (2 * input[i]) << std::endl;
+					passed = false;
+					break;
+				}
+			}
+		}
+
+		offload::free(buffer);
+	}
+
+	passed = (offload::progress() == 0) && passed;
+
+	std::cout << (passed ? "Test passed." : "Test failed.") << std::endl;
+
+	return passed ? 0 : -1;
+}
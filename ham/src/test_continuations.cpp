@@ -0,0 +1,111 @@
+// Copyright (c) 2013-2026 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "ham/offload.hpp"
+#include <iostream>
+#include <numeric>
+#include <tuple>
+#include <vector>
+
+using namespace ham;
+
+int sum(offload::buffer_ptr<int> data, size_t n)
+{
+	return std::accumulate(data.get(), data.get() + n, 0);
+}
+
+void scale(offload::buffer_ptr<int> data, size_t n, int factor)
+{
+	for (size_t i = 0; i < n; ++i)
+		data.get()[i] *= factor;
+}
+
+int square(int x)
+{
+	return x * x;
+}
+
+double half(int x)
+{
+	return x / 2.0;
+}
+
+int main(int argc, char* argv[])
+{
+	// avoid compiler warning
+	HAM_UNUSED_VAR(argc);
+	HAM_UNUSED_VAR(argv);
+
+	bool passed = true;
+	const size_t n = 1024;
+	const int pipelines = 4; // per target
+
+	std::vector<int> input(n);
+	std::iota(input.begin(), input.end(), 0);
+	const int input_sum = std::accumulate(input.begin(), input.end(), 0);
+
+	for (node_t target = 0; target < static_cast<node_t>(offload::num_nodes()); ++target) {
+		if (target == offload::this_node())
+			continue;
+
+		// put, then compute, then get, for several independent pipelines without blocking in between
+		std::vector<offload::buffer_ptr<int>> buffers;
+		std::vector<std::vector<int>> outputs(pipelines, std::vector<int>(n));
+		std::vector<offload::future<int>> sums;
+		for (int p = 0; p < pipelines; ++p) {
+			buffers.push_back(offload::allocate<int>(target, n));
+			offload::buffer_ptr<int> buffer = buffers.back();
+			int* output = outputs[p].data();
+			sums.push_back(offload::put(input.data(), buffers.back(), n)
+				.then([=]() { return offload::async(target, f2f(&scale, buffer, n, p + 1)); })
+				.then([=]() { return offload::get(buffer, output, n); })
+				.then([=]() { return offload::async(target, f2f(&sum, buffer, n)); }));
+		}
+
+		for (int p = 0; p < pipelines; ++p) {
+			const int result = sums[p].get();
+			if (result != (p + 1) * input_sum || outputs[p][n - 1] != (p + 1) * static_cast<int>(n - 1)) {
+				std::cout << "Error: target " << target << ", pipeline " << p << " returned " << result << ", expected " << ((p + 1) * input_sum) << std::endl;
+				passed = false;
+			}
+		}
+
+		for (auto& buffer : buffers)
+			offload::free(buffer);
+
+		// continuations returning values
+		auto doubled = offload::async(target, f2f(&square, 3)).then([](int x) { return 2 * x; });
+		passed = (doubled.get() == 18) && passed;
+
+		// when_all() of different types
+		auto all = offload::when_all(offload::async(target, f2f(&square, 4)), offload::async(target, f2f(&half, 5)));
+		auto all_results = all.get();
+		passed = (std::get<0>(all_results).get() == 16) && (std::get<1>(all_results).get() == 2.5) && passed;
+
+		// when_all() and when_any() of a vector
+		std::vector<offload::future<int>> futures;
+		for (int i = 0; i < 8; ++i)
+			futures.push_back(offload::async(target, f2f(&square, i)));
+		auto any_result = offload::when_any(std::move(futures)).get();
+		passed = (any_result.index < any_result.futures.size()) && passed;
+		passed = (any_result.futures[any_result.index].get() == static_cast<int>(any_result.index * any_result.index)) && passed;
+
+		auto squares = offload::when_all(std::move(any_result.futures)).then([](std::vector<offload::future<int>> ready) {
+			int total = 0;
+			for (auto& f : ready)
+				if (f.valid())
+					total += f.get();
+			return total;
+		});
+		const int expected = 140 - static_cast<int>(any_result.index * any_result.index); // sum of squares 0..7 without the one taken above
+		passed = (squares.get() == expected) && passed;
+	}
+
+	passed = (offload::progress() == 0) && passed;
+
+	std::cout << (passed ? "Test passed." : "Test failed.") << std::endl;
+
+	return passed ? 0 : -1;
+}
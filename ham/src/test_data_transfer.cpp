@@ -34,11 +34,7 @@ int main(int argc, char* argv[])
 
 	std::cout << "Testing data transfer: host -> target_a -> target_b -> host." << std::endl;
 
-#ifdef HAM_COMM_ONE_SIDED
 	constexpr size_t required_nodes = 2;
-#else
-	constexpr size_t required_nodes = 3;
-#endif
 
 	if (offload::num_nodes() < required_nodes) {
 		std::cerr << "This program needs at least " << required_nodes << " processes." << std::endl;
@@ -57,26 +53,30 @@ int main(int argc, char* argv[])
 
 	// specify two offload targets
 	offload::node_t target_a = 1; // we simply use the first device/node
-#ifndef HAM_COMM_ONE_SIDED
-	offload::node_t target_b = 2; // we simply use the second device/node
-#endif
+	offload::node_t target_b = offload::num_nodes() > 2 ? 2 : 1; // we simply use the second device/node, NOTE: or the first one again, which is a copy on the same node
 
 	// allocate device memory (returns a buffer_ptr<T>)
 	auto target_buffer_a = offload::allocate<double>(target_a, n);
-#ifndef HAM_COMM_ONE_SIDED
 	auto target_buffer_b = offload::allocate<double>(target_b, n);
-#endif
+
 	// host -> target_a -> target_b -> host
-	// NOTE: in case of HAM_COMM_ONE_SIDED we do: host -> target_a -> host
-	offload::put(write_buffer.data(), target_buffer_a, n);
-#ifndef HAM_COMM_ONE_SIDED
-	offload::copy_sync(target_buffer_a, target_buffer_b, n);
-	offload::get(target_buffer_b, read_buffer.data(), n);
-#else
-	offload::get(target_buffer_a, read_buffer.data(), n);
-#endif
+	offload::put(write_buffer.data(), target_buffer_a, n).get();
+	offload::copy_async(target_buffer_a, target_buffer_b, n).get();
+	offload::get(target_buffer_b, read_buffer.data(), n).get();
+
 	// verify
 	bool passed = compare(write_buffer, read_buffer);
+
+	// small transfers, which carry their data inside the messages on two-sided backends
+	for (size_t small_n : { size_t(1), size_t(3), size_t(100), n }) {
+		std::vector<double> small_write(small_n);
+		std::vector<double> small_read(small_n + 1, -1.0); // one more element, that must not be written
+		for (size_t i = 0; i < small_n; ++i)
+			small_write[i] = static_cast<double>(i) + 0.5;
+		offload::put(small_write.data(), target_buffer_a, small_n).get();
+		offload::get(target_buffer_a, small_read.data(), small_n).get();
+		passed = std::equal(small_write.begin(), small_write.end(), small_read.begin()) && small_read[small_n] == -1.0 && passed;
+	}
 	
 	std::cout << "Verified data? " << passed << std::endl;
 
@@ -0,0 +1,89 @@
+// Copyright (c) 2013-2026 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "ham/offload.hpp"
+#include <iostream>
+#include <vector>
+
+using namespace ham;
+
+int square(int x)
+{
+	return x * x;
+}
+
+void nothing()
+{
+}
+
+int main(int argc, char* argv[])
+{
+	// avoid compiler warning
+	HAM_UNUSED_VAR(argc);
+	HAM_UNUSED_VAR(argv);
+
+	bool passed = true;
+	const int calls = 4 * static_cast<int>(net::communicator::num_msg_buffers()); // more calls than message buffers per target, see --ham-msg-buffers
+
+	for (node_t target = 0; target < static_cast<node_t>(offload::num_nodes()); ++target) {
+		if (target == offload::this_node())
+			continue;
+
+		// a burst of outstanding calls, async() fetches the oldest results when it runs out of credits
+		// NOTE: no reserve(), so the futures are also moved while they are pending
+		std::vector<offload::future<int>> futures;
+		for (int i = 0; i < calls; ++i)
+			futures.push_back(offload::async(target, f2f(&square, i)));
+
+		for (int i = 0; i < calls; ++i) {
+			const int result = futures[i].get();
+			if (result != i * i) {
+				std::cout << "Error: target " << target << ", call " << i << " returned " << result << ", expected " << (i * i) << std::endl;
+				passed = false;
+			}
+		}
+		futures.clear();
+
+		// the same for void results
+		std::vector<offload::future<void>> void_futures;
+		for (int i = 0; i < calls; ++i)
+			void_futures.push_back(offload::async(target, f2f(&nothing)));
+		void_futures.clear(); // the destructors complete the protocol
+
+		// fire & forget calls return their credits, too
+		for (int i = 0; i < calls; ++i)
+			offload::ping(target, f2f(&nothing));
+		passed = (offload::sync(target, f2f(&square, 4)) == 16) && passed;
+		passed = (offload::progress() == 0) && passed; // pings do not leave continuations behind
+
+		// try_async() reports back-pressure instead of blocking
+		bool back_pressure = false;
+		for (int i = 0; i < calls; ++i) {
+			auto f = offload::try_async(target, f2f(&square, i));
+			if (!f.valid()) {
+				back_pressure = true;
+				break;
+			}
+			futures.push_back(std::move(f));
+		}
+		std::cout << "Target " << target << ": try_async() accepted " << futures.size() << " calls before reporting back-pressure" << std::endl;
+		if (!back_pressure) {
+			std::cout << "Error: try_async() did not report back-pressure after " << calls << " calls" << std::endl;
+			passed = false;
+		}
+
+		for (size_t i = 0; i < futures.size(); ++i)
+			passed = (futures[i].get() == static_cast<int>(i * i)) && passed;
+		futures.clear();
+
+		// the credits are back
+		auto f = offload::try_async(target, f2f(&square, 3));
+		passed = f.valid() && (f.get() == 9) && passed;
+	}
+
+	std::cout << (passed ? "Test passed." : "Test failed.") << std::endl;
+
+	return passed ? 0 : -1;
+}
@@ -0,0 +1,149 @@
+// Copyright (c) 2013-2026 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "ham/offload.hpp"
+#include <chrono>
+#include <iostream>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+using namespace ham;
+
+// NOTE: needs a communicator with HAM_COMM_PEER_OFFLOAD, and at least two targets
+
+constexpr size_t halo_size = 256;
+
+int sum(offload::buffer_ptr<int> data, size_t n)
+{
+	return std::accumulate(data.get(), data.get() + n, 0);
+}
+
+// the next target after this one, skipping the host
+node_t neighbour()
+{
+	node_t node = offload::this_node();
+	do {
+		node = static_cast<node_t>((node + 1) % offload::num_nodes());
+	} while (offload::is_host(node));
+	return node;
+}
+
+// executed on a target: sends a halo to the neighbour, and lets the neighbour sum it up
+int exchange_halo(int offset)
+{
+	std::vector<int> halo(halo_size);
+	std::iota(halo.begin(), halo.end(), offset);
+
+	const node_t target = neighbour();
+	offload::buffer_ptr<int> remote_halo = offload::allocate<int>(target, halo_size);
+	offload::put(halo.data(), remote_halo, halo_size).get();
+	const int result = offload::sync(target, f2f(&sum, remote_halo, halo_size));
+	offload::free(remote_halo);
+	return result;
+}
+
+// larger than constants::INLINE_TRANSFER_SIZE, so that the blocks are sent as separate, tagged transfers
+constexpr size_t block_size = 1024;
+
+// state of put_blocks() on a target, until wait_for_blocks()
+std::vector<int> block_data;
+std::vector<offload::future<void>> block_transfers;
+
+// executed on a target: starts putting blocks blocks into remote, and returns, so that the target can receive further messages
+// NOTE: the delay lets the host start its transfers between the same targets first
+void put_blocks(offload::buffer_ptr<int> remote, size_t blocks, int offset)
+{
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	block_data.resize(blocks * block_size);
+	std::iota(block_data.begin(), block_data.end(), offset);
+
+	for (size_t b = 0; b < blocks; ++b) {
+		offload::buffer_ptr<int> block = remote + b * block_size;
+		block_transfers.push_back(offload::put(block_data.data() + b * block_size, block, block_size));
+	}
+}
+
+void wait_for_blocks()
+{
+	offload::when_all(std::move(block_transfers)).get();
+	block_transfers.clear();
+}
+
+// transfers between two targets, that are initiated by one of them and by the host at the same time, must not match each other
+bool concurrent_transfers(node_t source, node_t dest)
+{
+	const size_t blocks = 16;
+	const size_t n = blocks * block_size;
+	bool passed = true;
+
+	std::vector<int> source_data(n);
+	std::iota(source_data.begin(), source_data.end(), 0);
+	offload::buffer_ptr<int> source_buffer = offload::allocate<int>(source, n);
+	offload::put(source_data.data(), source_buffer, n).get();
+
+	offload::buffer_ptr<int> copied = offload::allocate<int>(dest, n);
+	offload::buffer_ptr<int> put_by_source = offload::allocate<int>(dest, n);
+
+	auto puts_started = offload::async(source, f2f(&put_blocks, put_by_source, blocks, 1000000));
+	std::vector<offload::future<void>> copies;
+	for (size_t b = 0; b < blocks; ++b)
+		copies.push_back(offload::copy_async(source_buffer + b * block_size, copied + b * block_size, block_size));
+	offload::when_all(std::move(copies)).get();
+	puts_started.get();
+	offload::sync(source, f2f(&wait_for_blocks));
+
+	std::vector<int> result(n);
+	offload::get(copied, result.data(), n).get();
+	passed = (result == source_data) && passed;
+	offload::get(put_by_source, result.data(), n).get();
+	for (size_t i = 0; i < n; ++i)
+		passed = (result[i] == static_cast<int>(1000000 + i)) && passed;
+	if (!passed)
+		std::cout << "Error: concurrent transfers from target " << source << " to target " << dest << " were mixed up" << std::endl;
+
+	offload::free(source_buffer);
+	offload::free(copied);
+	offload::free(put_by_source);
+	return passed;
+}
+
+int main(int argc, char* argv[])
+{
+	// avoid compiler warning
+	HAM_UNUSED_VAR(argc);
+	HAM_UNUSED_VAR(argv);
+
+	bool passed = true;
+
+	// NOTE: one target at a time, since each one waits for its neighbour on its receiving thread
+	for (node_t target = 0; target < static_cast<node_t>(offload::num_nodes()); ++target) {
+		if (target == offload::this_node())
+			continue;
+
+		const int offset = static_cast<int>(target) * 1000;
+		std::vector<int> halo(halo_size);
+		std::iota(halo.begin(), halo.end(), offset);
+		const int expected = std::accumulate(halo.begin(), halo.end(), 0);
+
+		const int result = offload::sync(target, f2f(&exchange_halo, offset));
+		if (result != expected) {
+			std::cout << "Error: the neighbour of target " << target << " returned " << result << ", expected " << expected << std::endl;
+			passed = false;
+		}
+	}
+
+	for (node_t target = 0; target < static_cast<node_t>(offload::num_nodes()); ++target) {
+		if (offload::is_host(target))
+			continue;
+		const node_t next = offload::sync(target, f2f(&neighbour));
+		if (next != target)
+			passed = concurrent_transfers(target, next) && passed;
+	}
+
+	std::cout << (passed ? "Test passed." : "Test failed.") << std::endl;
+
+	return passed ? 0 : -1;
+}
@@ -0,0 +1,101 @@
+// Copyright (c) 2013-2026 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "ham/offload.hpp"
+#include <iostream>
+#include <vector>
+
+using namespace ham;
+
+// a by-value parameter block, larger than a message buffer
+struct parameter_block {
+	double values[4 * constants::MSG_SIZE / sizeof(double)];
+};
+
+double sum(parameter_block block, double scale)
+{
+	double result = 0.0;
+	for (double v : block.values)
+		result += v;
+	return result * scale;
+}
+
+// fits into a message buffer of the default size, but takes the rendezvous path with a smaller --ham-msg-size
+struct medium_block {
+	char values[constants::MSG_SIZE / 2];
+};
+
+int count(medium_block block, char value)
+{
+	int result = 0;
+	for (char v : block.values)
+		result += (v == value);
+	return result;
+}
+
+double small(double x)
+{
+	return 2.0 * x;
+}
+
+int main(int argc, char* argv[])
+{
+	// avoid compiler warning
+	HAM_UNUSED_VAR(argc);
+	HAM_UNUSED_VAR(argv);
+
+	parameter_block block;
+	const size_t n = sizeof(block.values) / sizeof(double);
+	for (size_t i = 0; i < n; ++i)
+		block.values[i] = static_cast<double>(i);
+	const double expected = static_cast<double>(n * (n - 1) / 2);
+
+	static_assert(!offload::is_eager<decltype(f2f(&sum, block, 1.0))>::value, "parameter_block must take the rendezvous path");
+	static_assert(offload::is_eager<decltype(f2f(&small, 1.0))>::value, "small functors must be sent eagerly");
+
+	medium_block medium;
+	for (size_t i = 0; i < sizeof(medium.values); ++i)
+		medium.values[i] = static_cast<char>(i % 2);
+
+	bool passed = true;
+
+	for (node_t target = 0; target < static_cast<node_t>(offload::num_nodes()); ++target) {
+		if (target == offload::this_node())
+			continue;
+
+		// sync
+		double result = offload::sync(target, f2f(&sum, block, 1.0));
+		if (result != expected) {
+			std::cout << "Error: target " << target << ", sync returned " << result << ", expected " << expected << std::endl;
+			passed = false;
+		}
+
+		// the path depends on --ham-msg-size
+		const int medium_result = offload::sync(target, f2f(&count, medium, static_cast<char>(1)));
+		if (medium_result != static_cast<int>(sizeof(medium.values) / 2)) {
+			std::cout << "Error: target " << target << ", the medium functor returned " << medium_result << ", expected " << sizeof(medium.values) / 2 << std::endl;
+			passed = false;
+		}
+
+		// multiple outstanding rendezvous calls, interleaved with eager ones
+		std::vector<offload::future<double>> futures;
+		for (int i = 0; i < 16; ++i) {
+			futures.push_back(offload::async(target, f2f(&sum, block, static_cast<double>(i))));
+			futures.push_back(offload::async(target, f2f(&small, static_cast<double>(i))));
+		}
+		for (int i = 0; i < 16; ++i) {
+			const double big_result = futures[2 * i].get();
+			const double small_result = futures[2 * i + 1].get();
+			if (big_result != expected * i || small_result != 2.0 * i) {
+				std::cout << "Error: target " << target << ", call " << i << " returned " << big_result << " and " << small_result << std::endl;
+				passed = false;
+			}
+		}
+	}
+
+	std::cout << (passed ? "Test passed." : "Test failed.") << std::endl;
+
+	return passed ? 0 : -1;
+}
@@ -0,0 +1,103 @@
+// Copyright (c) 2013-2026 Matthias Noack (ma.noack.pr@gmail.com)
+//
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "ham/offload.hpp"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace ham;
+
+// NOTE: run with --ham-target-threads 2 or more
+
+std::atomic<int> released { 0 }; // NOTE: shared by all targets of the threads backend, which are used one after another
+
+// a long-running call, that waits for a later call
+bool wait_for_release(int generation)
+{
+	const auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+	while (released.load() < generation) {
+		if (std::chrono::steady_clock::now() > timeout)
+			return false;
+		std::this_thread::yield();
+	}
+	return true;
+}
+
+void release(int generation)
+{
+	released.store(generation);
+}
+
+int square(int x)
+{
+	return x * x;
+}
+
+// true if called by the receiving thread of the target, which has the worker pool
+bool on_receiving_thread()
+{
+	return msg::worker_pool::current() != nullptr;
+}
+
+bool on_receiving_thread_non_blocking()
+{
+	return msg::worker_pool::current() != nullptr;
+}
+
+namespace ham {
+template<>
+struct is_blocking<F2F_TEMPLATE(&on_receiving_thread_non_blocking)> {
+	static constexpr bool value = false;
+};
+} // namespace ham
+
+int main(int argc, char* argv[])
+{
+	// avoid compiler warning
+	HAM_UNUSED_VAR(argc);
+	HAM_UNUSED_VAR(argv);
+
+	bool passed = true;
+	int generation = 0;
+	const int calls = 1000;
+
+	for (node_t target = 0; target < static_cast<node_t>(offload::num_nodes()); ++target) {
+		if (target == offload::this_node())
+			continue;
+
+		// the target keeps executing other calls, while a long-running one blocks a worker
+		++generation;
+		auto waiting = offload::async(target, f2f(&wait_for_release, generation));
+		offload::sync(target, f2f(&release, generation));
+		if (!waiting.get()) {
+			std::cout << "Error: target " << target << " did not execute another call while a long-running one was active" << std::endl;
+			passed = false;
+		}
+
+		// the execution policy is selected by is_blocking
+		if (offload::sync(target, f2f(&on_receiving_thread))) {
+			std::cout << "Error: target " << target << " executed a potentially blocking call on its receiving thread" << std::endl;
+			passed = false;
+		}
+		if (!offload::sync(target, f2f(&on_receiving_thread_non_blocking))) {
+			std::cout << "Error: target " << target << " did not execute a non-blocking call on its receiving thread" << std::endl;
+			passed = false;
+		}
+
+		// results are sent back by the workers concurrently
+		std::vector<offload::future<int>> futures;
+		for (int i = 0; i < calls; ++i)
+			futures.push_back(offload::async(target, f2f(&square, i)));
+		for (int i = 0; i < calls; ++i)
+			passed = (futures[i].get() == i * i) && passed;
+	}
+
+	std::cout << (passed ? "Test passed." : "Test failed.") << std::endl;
+
+	return passed ? 0 : -1;
+}